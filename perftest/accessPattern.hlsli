@@ -0,0 +1,92 @@
+#include "hash.hlsli"
+
+// Access patterns of the load kernels, shared by all kernel bodies. Every thread loads consecutive elements
+// (or a 16x16 texel block) starting from the element picked by the pattern. Define one of LOAD_INVARIANT,
+// LOAD_LINEAR, LOAD_RANDOM, LOAD_STRIDED, LOAD_MORTON, LOAD_DIVERGENT, LOAD_CLUSTERED, LOAD_INDEXED or
+// LOAD_PAGED (buffer kernels only).
+// Include after the loadConstants cbuffer. The pattern parameters are shared with the CPU reference.
+
+#if defined(LOAD_INDEXED)
+// Shuffled start elements (0-255), one per thread of a group
+Buffer<uint> gatherIndices : register(t1);
+#define PATTERN_SRVS "SRV(t1, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"
+#else
+#define PATTERN_SRVS
+#endif
+
+// 8-bit Morton code to 4-bit x and y
+uint2 mortonDecode(uint code)
+{
+	uint2 xy = uint2(code, code >> 1) & 0x55;
+	xy = (xy | (xy >> 1)) & 0x33;
+	xy = (xy | (xy >> 2)) & 0x0f;
+	return xy;
+}
+
+// Start element of a buffer kernel thread
+uint patternStart(uint gix)
+{
+#if defined(LOAD_INVARIANT)
+    // All threads load from same address. Index is wave invariant.
+	return 0;
+#elif defined(LOAD_LINEAR)
+	// Linearly increasing starting address to allow memory coalescing
+	return gix;
+#elif defined(LOAD_RANDOM)
+    // Randomize start address offset (0-15) to prevent memory coalescing
+	return hash1(gix) & 0xf;
+#elif defined(LOAD_STRIDED)
+	// Constant stride between neighbour threads. Wraps at 512 elements to stay inside the buffers.
+	return (gix * PATTERN_STRIDE) & 0x1ff;
+#elif defined(LOAD_MORTON)
+	// Threads walk a 16x16 tile of a 2d array (row pitch 32 elements) in Morton order
+	uint2 xy = mortonDecode(gix);
+	return xy.y * 32 + xy.x;
+#elif defined(LOAD_DIVERGENT)
+	// Interleaved thread groups, each loading the same address. patternWays addresses per wave, 8 elements
+	// apart. Separate 128 byte cache lines only for 16 byte elements: the divergent buffer kernels are only
+	// run on float4 and RGBA32F sources.
+	return (gix % loadConstants.patternWays) * 8;
+#elif defined(LOAD_CLUSTERED)
+	// Clusters of PATTERN_CLUSTER threads load linearly, from a randomized cluster start (0-15)
+	return (hash1(gix / PATTERN_CLUSTER) & 0xf) * PATTERN_CLUSTER + gix % PATTERN_CLUSTER;
+#elif defined(LOAD_INDEXED)
+	// Start element fetched from an index buffer. The gather depends on that load.
+	return gatherIndices[gix];
+#elif defined(LOAD_PAGED)
+	// Threads of a group spread evenly over a large buffer. Every lane of a load hits a different page.
+	return gix * loadConstants.pageStride;
+#endif
+}
+
+// Start texel of a texture kernel thread in its 16x16 group
+uint2 patternStart2d(uint2 gid)
+{
+#if defined(LOAD_INVARIANT)
+    // All threads load from same address. Index is wave invariant.
+	return 0;
+#elif defined(LOAD_LINEAR)
+	// Linearly increasing starting address.
+	return gid;
+#elif defined(LOAD_RANDOM)
+    // Randomize start address offset (0-3, 0-3)
+	return uint2((hash1(gid.x) & 0x4), (hash1(gid.y) & 0x4));
+#elif defined(LOAD_STRIDED)
+	// Constant stride between neighbour threads in both axes, wrapped to 16 texels
+	return (gid * PATTERN_STRIDE) & 0xf;
+#elif defined(LOAD_MORTON)
+	// Threads of the group in Morton order instead of row major
+	return mortonDecode(gid.y * 16 + gid.x);
+#elif defined(LOAD_DIVERGENT)
+	// Interleaved thread groups, each loading the same texel. patternWays separate 2x2 texel quads.
+	uint way = (gid.y * 16 + gid.x) % loadConstants.patternWays;
+	return uint2(way % 8, way / 8) * 2;
+#elif defined(LOAD_CLUSTERED)
+	// 4x4 thread clusters load linearly, from a randomized cluster start
+	return uint2((hash1(gid.x / 4) & 0xc), (hash1(gid.y / 4) & 0xc)) + gid % 4;
+#elif defined(LOAD_INDEXED)
+	// Start texel fetched from an index buffer (x in the low 4 bits)
+	uint index = gatherIndices[gid.y * 16 + gid.x];
+	return uint2(index & 0xf, index >> 4);
+#endif
+}
@@ -0,0 +1,54 @@
+#include "addressTrace.h"
+#include "file.h"
+#include "loadConstantsGPU.h"
+#include <cstdio>
+#include <cstring>
+
+std::optional<AddressTrace> loadAddressTrace(const std::string& filename)
+{
+	std::vector<unsigned char> data = loadFile(filename);
+	uint32_t header[2] = {};
+	if (data.size() < sizeof(header))
+	{
+		printf("Address trace %s: missing header\n", filename.c_str());
+		return {};
+	}
+	memcpy(header, data.data(), sizeof(header));
+
+	uint64_t fileThreads = header[0];
+	uint64_t loads = header[1];
+	if (fileThreads == 0 || loads == 0 || data.size() != sizeof(header) + fileThreads * loads * 4)
+	{
+		printf("Address trace %s: %llu threads x %llu loads doesn't match the file size\n", filename.c_str(),
+			(unsigned long long)fileThreads, (unsigned long long)loads);
+		return {};
+	}
+
+	AddressTrace trace;
+	trace.filename = filename;
+	trace.threadCount = fileThreads < TRACE_MAX_THREADS ? (unsigned)fileThreads : TRACE_MAX_THREADS;
+	trace.loadsPerThread = (unsigned)loads;
+	if (fileThreads > TRACE_MAX_THREADS)
+		printf("Address trace %s: replaying the first %u of %llu threads\n", filename.c_str(), TRACE_MAX_THREADS, (unsigned long long)fileThreads);
+
+	// Transpose to load major order. A load of all threads is then a linear index fetch.
+	const unsigned char* threadIndices = data.data() + sizeof(header);
+	trace.indices.resize((size_t)trace.threadCount * trace.loadsPerThread);
+	for (unsigned thread = 0; thread < trace.threadCount; thread++)
+	{
+		for (unsigned load = 0; load < trace.loadsPerThread; load++)
+		{
+			uint32_t& index = trace.indices[(size_t)load * trace.threadCount + thread];
+			memcpy(&index, &threadIndices[((size_t)thread * loads + load) * 4], 4);
+			if (index >= TRACE_MAX_ELEMENTS)
+			{
+				printf("Address trace %s: element index %u of thread %u is above the %u elements of the trace sources\n",
+					filename.c_str(), index, thread, TRACE_MAX_ELEMENTS);
+				return {};
+			}
+			if (index >= trace.elementCount)
+				trace.elementCount = index + 1;
+		}
+	}
+	return trace;
+}
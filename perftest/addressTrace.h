@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Captured per-thread address sequences, replayed by the trace kernels (loadTraceBody.hlsli)
+struct AddressTrace
+{
+	std::string filename;
+	unsigned threadCount = 0;		// Threads of one thread group, at most TRACE_MAX_THREADS
+	unsigned loadsPerThread = 0;
+	unsigned elementCount = 0;		// Largest element index + 1, the float4 elements of the sources
+	std::vector<uint32_t> indices;	// Load major element indices: indices[load * threadCount + thread]
+};
+
+// Little endian uint32 file: thread count, loads per thread, then the element indices of every thread
+// in thread order. Threads above TRACE_MAX_THREADS are dropped. Prints the reason of a malformed file, or of
+// an element index of TRACE_MAX_ELEMENTS or more.
+std::optional<AddressTrace> loadAddressTrace(const std::string& filename);
@@ -0,0 +1,22 @@
+// Bindless variant of a load kernel. The source is fetched from the descriptor heap (SM 6.6) instead
+// of a descriptor table. Define SOURCE_TYPE and one of BINDLESS_UNIFORM, BINDLESS_WAVE_UNIFORM or
+// BINDLESS_NON_UNIFORM before including, and include before the kernel body.
+#define BINDLESS
+
+// All descriptor copies view the same resource, so every index mode loads the same data
+#if defined(BINDLESS_UNIFORM)
+	// Same descriptor for the whole dispatch
+	#define BINDLESS_INDEX(gix) (loadConstants.descriptorIndex)
+#elif defined(BINDLESS_WAVE_UNIFORM)
+	// Different descriptor per wave, provably uniform within the wave
+	#define BINDLESS_INDEX(gix) WaveReadLaneFirst(loadConstants.descriptorIndex + ((gix) / WaveGetLaneCount()) % BINDLESS_DESCRIPTOR_COPIES)
+#elif defined(BINDLESS_NON_UNIFORM)
+	// Different descriptor per lane
+	#define BINDLESS_INDEX(gix) NonUniformResourceIndex(loadConstants.descriptorIndex + (gix) % BINDLESS_DESCRIPTOR_COPIES)
+#endif
+
+#define ROOT_SIGNATURE \
+	"RootFlags(CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED)," \
+	"DescriptorTable(" \
+		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
@@ -2,6 +2,11 @@
 setlocal enabledelayedexpansion
 
 for %%f in (*.hlsl) do (
-    echo Compiling %%f...
-    fxc /T cs_5_1 /E main /Zi /Fo shaders\%%~nf.cso %%f
+    echo %%f | findstr /c:"Bindless" /c:"dF16" /c:"dU16" /c:"dU64" /c:"Timed" >nul
+    if errorlevel 1 (
+        echo Compiling %%f...
+        fxc /T cs_5_1 /E main /Zi /Fo shaders\%%~nf.cso %%f
+    ) else (
+        echo Skipping %%f, needs SM 6.0+ ^(compile_shaders_6_0.bat^)
+    )
 )
@@ -3,5 +3,11 @@ setlocal enabledelayedexpansion
 
 for %%f in (*.hlsl) do (
     echo Compiling %%f...
-    dxc /T cs_6_0 /E main /Zi /Fo shaders\%%~nf.cso /Fd shaders\ %%f
+    rem Bindless kernels index the descriptor heap directly, SM 6.6
+    rem Native 16/64-bit type kernels use templated loads and 16-bit types, SM 6.2
+    set profile=cs_6_0
+    set options=
+    echo %%f | findstr /c:"Bindless" >nul && set profile=cs_6_6
+    echo %%f | findstr /c:"dF16" /c:"dU16" /c:"dU64" >nul && set profile=cs_6_2&& set options=-enable-16bit-types
+    dxc /T !profile! !options! /E main /Zi /Fo shaders\%%~nf.cso /Fd shaders\ %%f
 )
@@ -1,7 +1,9 @@
 #include "directx.h"
+#include "timelineTrace.h"
+#include "gpuMarkers.h"
 #include <assert.h>
-#define USE_PIX 1
-#include <pix3.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 ComPtr<IDXGIFactory4> GDXGIFactory;
 
@@ -26,13 +28,42 @@ static D3D12_RESOURCE_DESC InitBufferResourceDesc(size_t sizeInBytes)
 	};
 }
 
+static D3D12_RESOURCE_DESC InitTexture2dResourceDesc(uint2 dimensions, DXGI_FORMAT format, unsigned mips)
+{
+	return
+	{
+		.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
+		.Alignment = 0,
+		.Width = dimensions.x,
+		.Height = dimensions.y,
+		.DepthOrArraySize = 1,
+		.MipLevels = (UINT16)mips,
+		.Format = format,
+		.SampleDesc =
+		{
+			.Count = 1,
+			.Quality = 0,
+		},
+		.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN,
+		.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS
+	};
+}
+
+static bool IsCpuAccessible(const D3D12_HEAP_PROPERTIES& heapProps)
+{
+	if (heapProps.Type == D3D12_HEAP_TYPE_CUSTOM)
+		return heapProps.CPUPageProperty != D3D12_CPU_PAGE_PROPERTY_NOT_AVAILABLE;
+	return heapProps.Type == D3D12_HEAP_TYPE_UPLOAD || heapProps.Type == D3D12_HEAP_TYPE_READBACK;
+}
+
 static UINT Align(UINT value, UINT alignment)
 {
 	UINT mask = alignment - 1;
 	return (value + mask) & ~mask;
 }
 
-ComputePSO::ComputePSO(ID3D12Device* device, const std::string& name, const std::vector<unsigned char>& shaderBytes)
+ComputePSO::ComputePSO(ID3D12Device* device, const std::string& name, const std::vector<unsigned char>& shaderBytes) :
+	name(name)
 {
 	D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc =
 	{
@@ -112,15 +143,25 @@ ComputePSO::ComputePSO(ID3D12Device* device, const std::string& name, const std:
 				bindingType = EBindingType::kCbv;
 			else if (rootParam.ParameterType == D3D12_ROOT_PARAMETER_TYPE_UAV)
 				bindingType = EBindingType::kUav;
+			else if (rootParam.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+				bindingType = EBindingType::kCbv;
 			else
 				assert(false);
 
 			binding.isRootDescriptor = true;
-			bindings[(int)bindingType][rootParam.Descriptor.ShaderRegister] = binding;
+			if (rootParam.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS)
+			{
+				binding.num32BitConstants = rootParam.Constants.Num32BitValues;
+				bindings[(int)bindingType][rootParam.Constants.ShaderRegister] = binding;
+			}
+			else
+			{
+				bindings[(int)bindingType][rootParam.Descriptor.ShaderRegister] = binding;
+			}
 
 			RootParameter ourRootParam = {
 				.type = rootParam.ParameterType,
-				.numDescriptors = 1
+				.numDescriptors = rootParam.ParameterType == D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS ? 0u : 1u
 			};
 			rootSignatureDesc.push_back(ourRootParam);
 		}
@@ -165,6 +206,31 @@ std::vector<ComPtr<IDXGIAdapter>> enumerateAdapters()
 	return adapters;
 }
 
+unsigned getFormatBytes(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R8_UNORM:
+		return 1;
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R16_FLOAT:
+		return 2;
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_TYPELESS:
+		return 4;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R32G32_FLOAT:
+		return 8;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		return 16;
+	default:
+		assert(false);
+		return 0;
+	}
+}
+
 DirectXDevice::DirectXDevice(HWND window, uint2 resolution, IDXGIAdapter* adapter) : 
 	windowHandle(window),
 	resolution(resolution)
@@ -206,18 +272,32 @@ DirectXDevice::DirectXDevice(HWND window, uint2 resolution, IDXGIAdapter* adapte
 	fenceEvent = CreateEvent(nullptr, false, false, nullptr);
 	assert(fenceEvent);
 
-	result = device->CreateCommandAllocator(queueDesc.Type, IID_PPV_ARGS(cmdAllocator.GetAddressOf()));
-	assert(SUCCEEDED(result));
+	for (FrameContext& frame : frames)
+	{
+		result = device->CreateCommandAllocator(queueDesc.Type, IID_PPV_ARGS(frame.cmdAllocator.GetAddressOf()));
+		assert(SUCCEEDED(result));
+	}
 
 	result = device->CreateCommandList(
 		0,
 		queueDesc.Type,
-		cmdAllocator.Get(),
+		frames[0].cmdAllocator.Get(),
 		nullptr,
 		IID_PPV_ARGS(cmdList.GetAddressOf()));
 	assert(SUCCEEDED(result));
 	cmdList->Close();
 
+	result = device->CreateCommandAllocator(queueDesc.Type, IID_PPV_ARGS(immediateCmdAllocator.GetAddressOf()));
+	assert(SUCCEEDED(result));
+	result = device->CreateCommandList(
+		0,
+		queueDesc.Type,
+		immediateCmdAllocator.Get(),
+		nullptr,
+		IID_PPV_ARGS(immediateCmdList.GetAddressOf()));
+	assert(SUCCEEDED(result));
+	immediateCmdList->Close();
+
 	DXGI_SWAP_CHAIN_DESC1 swapDesc = {
 		.Width = resolution.x,
 		.Height = resolution.y,
@@ -226,7 +306,7 @@ DirectXDevice::DirectXDevice(HWND window, uint2 resolution, IDXGIAdapter* adapte
 			.Count = 1,
 			.Quality = 0},
 		.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT, // RT needed for GDI text output
-		.BufferCount = 2,
+		.BufferCount = numFramesInFlight,
 		.Scaling = DXGI_SCALING_NONE,
 		.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL,
 		.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH };
@@ -242,42 +322,67 @@ DirectXDevice::DirectXDevice(HWND window, uint2 resolution, IDXGIAdapter* adapte
 
 	D3D12_QUERY_HEAP_DESC queryHeapDesc = {
 		.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
-		.Count = (UINT)queries.size() * 2};
+		.Count = numFramesInFlight * maxQueriesPerFrame * 2};
 	result = device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(queryHeap.GetAddressOf()));
 	assert(SUCCEEDED(result));
 
-	D3D12_RESOURCE_DESC resourceDesc = InitBufferResourceDesc(queryHeapDesc.Count * sizeof(uint64_t));
+	D3D12_RESOURCE_DESC resourceDesc = InitBufferResourceDesc(maxQueriesPerFrame * 2 * sizeof(uint64_t));
 	D3D12_HEAP_PROPERTIES heapProps = { .Type = D3D12_HEAP_TYPE_READBACK };
-	result = device->CreateCommittedResource(
-		&heapProps,
-		D3D12_HEAP_FLAG_NONE,
-		&resourceDesc,
-		D3D12_RESOURCE_STATE_COPY_DEST,
-		nullptr,
-		IID_PPV_ARGS(queryResultBuffer.GetAddressOf()));
-	assert(SUCCEEDED(result));
+	for (FrameContext& frame : frames)
+	{
+		result = device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr,
+			IID_PPV_ARGS(frame.queryResultBuffer.GetAddressOf()));
+		assert(SUCCEEDED(result));
+		frame.queries.resize(maxQueriesPerFrame);
+	}
 
 	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {
 		.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
-		.NumDescriptors = 100'000,
+		.NumDescriptors = numFramesInFlight * cbvSrvUavDescriptorsPerFrame + maxBindlessDescriptors,
 		.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE};
 	result = device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(cbvSrvUavDescriptorHeap.GetAddressOf()));
+	assert(SUCCEEDED(result));
+	bindlessDescriptorsStart = numFramesInFlight * cbvSrvUavDescriptorsPerFrame;
 
 	heapDesc = {
 		.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER,
-		.NumDescriptors = 1'000,
+		.NumDescriptors = numFramesInFlight * samplerDescriptorsPerFrame,
 		.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE };
 	result = device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(samplerDescriptorHeap.GetAddressOf()));
+	assert(SUCCEEDED(result));
 }
 
 DirectXDevice::~DirectXDevice()
 {
-	cmdQueue->Signal(fence.Get(), ++fenceLastSignalVal);
-	HRESULT hr = fence->SetEventOnCompletion(fenceLastSignalVal, fenceEvent);
+	waitForIdle();
+
+	CloseHandle(fenceEvent);
+}
+
+void DirectXDevice::waitForFence(UINT64 fenceValue)
+{
+	if (fence->GetCompletedValue() >= fenceValue)
+		return;
+
+	uint64_t waitStart = timeline ? TimelineTrace::cpuTimestamp() : 0;
+	HRESULT hr = fence->SetEventOnCompletion(fenceValue, fenceEvent);
 	assert(SUCCEEDED(hr));
 	WaitForSingleObject(fenceEvent, INFINITE);
+	if (timeline)
+		timeline->addCpuSpan("Fence wait", frameCounter, waitStart, TimelineTrace::cpuTimestamp());
+}
 
-	CloseHandle(fenceEvent);
+void DirectXDevice::waitForIdle()
+{
+	for (QueueContext& queue : extraQueues)
+		cmdQueue->Wait(queue.fence.Get(), queue.fenceValue);
+	cmdQueue->Signal(fence.Get(), ++fenceLastSignalVal);
+	waitForFence(fenceLastSignalVal);
 }
 
 ComPtr<ID3D12Resource> DirectXDevice::createConstantBuffer(unsigned bytes)
@@ -296,54 +401,113 @@ ComPtr<ID3D12Resource> DirectXDevice::createConstantBuffer(unsigned bytes)
 	return resource;
 }
 
-ComPtr<ID3D12Resource> DirectXDevice::createBuffer(unsigned numElements, unsigned strideBytes)
+ComPtr<ID3D12Resource> DirectXDevice::createUploadBuffer(unsigned bytes)
 {
-	auto resourceDesc = InitBufferResourceDesc(strideBytes * numElements);
-	resourceDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-	D3D12_HEAP_PROPERTIES heapProps = { .Type = D3D12_HEAP_TYPE_DEFAULT };
+	auto resourceDesc = InitBufferResourceDesc(bytes);
+	D3D12_HEAP_PROPERTIES heapProps = { .Type = D3D12_HEAP_TYPE_UPLOAD };
 	ComPtr<ID3D12Resource> resource;
 	HRESULT result = device->CreateCommittedResource(
 		&heapProps,
 		D3D12_HEAP_FLAG_NONE,
 		&resourceDesc,
-		D3D12_RESOURCE_STATE_COMMON,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
 		nullptr,
 		IID_PPV_ARGS(resource.GetAddressOf()));
 	assert(SUCCEEDED(result));
 	return resource;
 }
 
-ComPtr<ID3D12Resource> DirectXDevice::createTexture2d(uint2 dimensions, DXGI_FORMAT format, unsigned mips)
+ComPtr<ID3D12Resource> DirectXDevice::createReadbackBuffer(unsigned bytes)
 {
-	D3D12_RESOURCE_DESC textureDesc = {
-		.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
-		.Alignment = 0,
-		.Width = dimensions.x,
-		.Height = dimensions.y,
-		.DepthOrArraySize = 1,
-		.MipLevels = (UINT16)mips,
-		.Format = format,
-		.SampleDesc =
-		{
-			.Count = 1,
-			.Quality = 0,
-		},
-		.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN,
-		.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS};
-
-	D3D12_HEAP_PROPERTIES heapProps = { .Type = D3D12_HEAP_TYPE_DEFAULT };
+	auto resourceDesc = InitBufferResourceDesc(bytes);
+	D3D12_HEAP_PROPERTIES heapProps = { .Type = D3D12_HEAP_TYPE_READBACK };
 	ComPtr<ID3D12Resource> resource;
 	HRESULT result = device->CreateCommittedResource(
 		&heapProps,
 		D3D12_HEAP_FLAG_NONE,
-		&textureDesc,
-		D3D12_RESOURCE_STATE_COMMON,
+		&resourceDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST,
 		nullptr,
 		IID_PPV_ARGS(resource.GetAddressOf()));
 	assert(SUCCEEDED(result));
 	return resource;
 }
 
+ComPtr<ID3D12Resource> DirectXDevice::createBuffer(unsigned numElements, unsigned strideBytes, const ResourcePlacement& placement)
+{
+	auto resourceDesc = InitBufferResourceDesc(strideBytes * numElements);
+	resourceDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+	return createResource(resourceDesc, placement);
+}
+
+ComPtr<ID3D12Resource> DirectXDevice::createTexture2d(uint2 dimensions, DXGI_FORMAT format, unsigned mips, const ResourcePlacement& placement)
+{
+	return createResource(InitTexture2dResourceDesc(dimensions, format, mips), placement);
+}
+
+ComPtr<ID3D12Resource> DirectXDevice::createResource(const D3D12_RESOURCE_DESC& desc, const ResourcePlacement& placement)
+{
+	D3D12_RESOURCE_DESC resourceDesc = desc;
+	resourceDesc.Alignment = placement.alignment;
+	if (IsCpuAccessible(placement.heapProperties))
+		resourceDesc.Flags &= ~D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+	ComPtr<ID3D12Resource> resource;
+	HRESULT result;
+	if (placement.heap)
+	{
+		result = device->CreatePlacedResource(
+			placement.heap,
+			placement.heapOffset,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(resource.GetAddressOf()));
+	}
+	else
+	{
+		result = device->CreateCommittedResource(
+			&placement.heapProperties,
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(resource.GetAddressOf()));
+	}
+
+	// Non-default placements are allowed to fail, e.g. textures in CPU visible heaps
+	bool defaultPlacement = !placement.heap && placement.heapProperties.Type == D3D12_HEAP_TYPE_DEFAULT;
+	assert(SUCCEEDED(result) || !defaultPlacement);
+	if (FAILED(result))
+		return nullptr;
+	return resource;
+}
+
+ComPtr<ID3D12Heap> DirectXDevice::createHeap(UINT64 bytes, D3D12_HEAP_FLAGS flags, UINT64 alignment)
+{
+	D3D12_HEAP_DESC heapDesc = {
+		.SizeInBytes = bytes,
+		.Properties = { .Type = D3D12_HEAP_TYPE_DEFAULT },
+		.Alignment = alignment,
+		.Flags = flags };
+	ComPtr<ID3D12Heap> heap;
+	HRESULT result = device->CreateHeap(&heapDesc, IID_PPV_ARGS(heap.GetAddressOf()));
+	assert(SUCCEEDED(result));
+	return heap;
+}
+
+D3D12_HEAP_PROPERTIES DirectXDevice::getCustomHeapProperties(D3D12_HEAP_TYPE type)
+{
+	return device->GetCustomHeapProperties(0, type);
+}
+
+D3D12_RESOURCE_ALLOCATION_INFO DirectXDevice::getTexture2dAllocationInfo(uint2 dimensions, DXGI_FORMAT format, unsigned mips, UINT64 alignment)
+{
+	D3D12_RESOURCE_DESC desc = InitTexture2dResourceDesc(dimensions, format, mips);
+	desc.Alignment = alignment;
+	return device->GetResourceAllocationInfo(0, 1, &desc);
+}
+
 ComPtr<ID3D12Resource> DirectXDevice::createTexture3d(uint3 dimensions, DXGI_FORMAT format, unsigned mips)
 {
 	D3D12_RESOURCE_DESC textureDesc = {
@@ -453,6 +617,71 @@ ShaderResourceView DirectXDevice::createByteAddressSRV(ID3D12Resource *buffer, u
 	return ShaderResourceView(buffer, desc);
 }
 
+bool DirectXDevice::supportsShaderModel(D3D_SHADER_MODEL shaderModel)
+{
+	D3D12_FEATURE_DATA_SHADER_MODEL data = { .HighestShaderModel = shaderModel };
+	if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &data, sizeof(data))))
+		return false;
+	return data.HighestShaderModel >= shaderModel;
+}
+
+bool DirectXDevice::supportsBindless()
+{
+	if (!supportsShaderModel(D3D_SHADER_MODEL_6_6))
+		return false;
+
+	D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+	if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))))
+		return false;
+	return options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3;
+}
+
+bool DirectXDevice::supports16BitTypes()
+{
+	if (!supportsShaderModel(D3D_SHADER_MODEL_6_2))
+		return false;
+
+	D3D12_FEATURE_DATA_D3D12_OPTIONS4 options = {};
+	if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS4, &options, sizeof(options))))
+		return false;
+	return options.Native16BitShaderOpsSupported;
+}
+
+bool DirectXDevice::supportsInt64()
+{
+	if (!supportsShaderModel(D3D_SHADER_MODEL_6_2))
+		return false;
+
+	D3D12_FEATURE_DATA_D3D12_OPTIONS1 options = {};
+	if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS1, &options, sizeof(options))))
+		return false;
+	return options.Int64ShaderOps;
+}
+
+unsigned DirectXDevice::getWaveLaneCount()
+{
+	D3D12_FEATURE_DATA_D3D12_OPTIONS1 options = {};
+	if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS1, &options, sizeof(options))) || !options.WaveOps)
+		return 0;
+	return options.WaveLaneCountMax;
+}
+
+unsigned DirectXDevice::createBindlessSRV(const ShaderResourceView& view, unsigned count)
+{
+	assert(numBindlessDescriptors + count <= maxBindlessDescriptors);
+	unsigned heapIndex = bindlessDescriptorsStart + numBindlessDescriptors;
+	numBindlessDescriptors += count;
+
+	uint32_t descriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	for (unsigned i = 0; i < count; i++)
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE descriptorAddr = {
+			cbvSrvUavDescriptorHeap->GetCPUDescriptorHandleForHeapStart().ptr + descriptorSize * (heapIndex + i) };
+		device->CreateShaderResourceView(view.resource, view.desc.has_value() ? &view.desc.value() : nullptr, descriptorAddr);
+	}
+	return heapIndex;
+}
+
 SamplerState DirectXDevice::createSampler(SamplerType type)
 {
 	D3D12_SAMPLER_DESC desc =
@@ -483,6 +712,113 @@ SamplerState DirectXDevice::createSampler(SamplerType type)
 	return SamplerState(desc);
 }
 
+void DirectXDevice::updateConstantBuffer(ID3D12Resource* cbuffer, const void* data, unsigned bytes)
+{
+	writeBuffer(cbuffer, data, bytes);
+	constantBufferData[cbuffer].assign((const unsigned char*)data, (const unsigned char*)data + bytes);
+}
+
+void DirectXDevice::writeBuffer(ID3D12Resource* uploadBuffer, const void* data, unsigned bytes)
+{
+	void* ptr = nullptr;
+	D3D12_RANGE readRange = {};
+	HRESULT result = uploadBuffer->Map(0, &readRange, &ptr);
+	assert(SUCCEEDED(result));
+	memcpy(ptr, data, bytes);
+	uploadBuffer->Unmap(0, nullptr);
+}
+
+void DirectXDevice::readBuffer(ID3D12Resource* readbackBuffer, void* data, unsigned bytes)
+{
+	void* ptr = nullptr;
+	D3D12_RANGE readRange = { 0, bytes };
+	HRESULT result = readbackBuffer->Map(0, &readRange, &ptr);
+	assert(SUCCEEDED(result));
+	memcpy(data, ptr, bytes);
+	D3D12_RANGE writtenRange = {};
+	readbackBuffer->Unmap(0, &writtenRange);
+}
+
+void DirectXDevice::executeImmediate(const std::function<void(ID3D12GraphicsCommandList*)>& record)
+{
+	immediateCmdAllocator->Reset();
+	immediateCmdList->Reset(immediateCmdAllocator.Get(), nullptr);
+	record(immediateCmdList.Get());
+	immediateCmdList->Close();
+
+	auto cmdListToSubmit = (ID3D12CommandList*)immediateCmdList.Get();
+	cmdQueue->ExecuteCommandLists(1, &cmdListToSubmit);
+	waitForIdle();
+}
+
+void DirectXDevice::uploadBuffer(ID3D12Resource* buffer, const void* data, unsigned bytes)
+{
+	D3D12_HEAP_PROPERTIES heapProps;
+	HRESULT result = buffer->GetHeapProperties(&heapProps, nullptr);
+	assert(SUCCEEDED(result));
+	if (IsCpuAccessible(heapProps))
+	{
+		writeBuffer(buffer, data, bytes);
+		return;
+	}
+
+	ComPtr<ID3D12Resource> staging = createUploadBuffer(bytes);
+	writeBuffer(staging.Get(), data, bytes);
+
+	// Resources are created in the common state. The copy promotes them implicitly, and they decay back afterwards.
+	executeImmediate([&](ID3D12GraphicsCommandList* list)
+	{
+		list->CopyBufferRegion(buffer, 0, staging.Get(), 0, bytes);
+	});
+}
+
+void DirectXDevice::uploadTexture2d(ID3D12Resource* texture, const void* data)
+{
+	D3D12_RESOURCE_DESC desc = texture->GetDesc();
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	UINT numRows;
+	UINT64 rowBytes;
+	UINT64 totalBytes;
+	device->GetCopyableFootprints(&desc, 0, 1, 0, &footprint, &numRows, &rowBytes, &totalBytes);
+
+	D3D12_HEAP_PROPERTIES heapProps;
+	HRESULT result = texture->GetHeapProperties(&heapProps, nullptr);
+	assert(SUCCEEDED(result));
+	if (IsCpuAccessible(heapProps))
+	{
+		// Unknown layout, the driver swizzles on the CPU
+		result = texture->Map(0, nullptr, nullptr);
+		assert(SUCCEEDED(result));
+		result = texture->WriteToSubresource(0, nullptr, data, (UINT)rowBytes, (UINT)(rowBytes * numRows));
+		assert(SUCCEEDED(result));
+		texture->Unmap(0, nullptr);
+		return;
+	}
+
+	// Staging rows are aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+	ComPtr<ID3D12Resource> staging = createUploadBuffer((unsigned)totalBytes);
+	unsigned char* ptr = nullptr;
+	D3D12_RANGE readRange = {};
+	result = staging->Map(0, &readRange, (void**)&ptr);
+	assert(SUCCEEDED(result));
+	for (UINT row = 0; row < numRows; row++)
+		memcpy(ptr + footprint.Offset + row * footprint.Footprint.RowPitch, (const unsigned char*)data + row * rowBytes, rowBytes);
+	staging->Unmap(0, nullptr);
+
+	executeImmediate([&](ID3D12GraphicsCommandList* list)
+	{
+		D3D12_TEXTURE_COPY_LOCATION dst = {
+			.pResource = texture,
+			.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+			.SubresourceIndex = 0 };
+		D3D12_TEXTURE_COPY_LOCATION src = {
+			.pResource = staging.Get(),
+			.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+			.PlacedFootprint = footprint };
+		list->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	});
+}
+
 ComputePSO DirectXDevice::createComputeShader(const std::string& name, const std::vector<unsigned char> &shaderBytes)
 {
 	return ComputePSO(device.Get(), name, shaderBytes);
@@ -490,8 +826,17 @@ ComputePSO DirectXDevice::createComputeShader(const std::string& name, const std
 
 void DirectXDevice::beginFrame()
 {
-	cmdAllocator->Reset();
-	cmdList->Reset(cmdAllocator.Get(), nullptr);
+	// Only blocks when the GPU is numFramesInFlight frames behind
+	FrameContext& frame = frames[frameIndex];
+	waitForFence(frame.fenceValue);
+
+	frame.numQueries = 0;
+	frame.frameNumber = frameCounter;
+	frame.resultsPending = false;
+	frame.recordStart = timeline ? TimelineTrace::cpuTimestamp() : 0;
+
+	frame.cmdAllocator->Reset();
+	cmdList->Reset(frame.cmdAllocator.Get(), nullptr);
 
 	D3D12_VIEWPORT viewport;
 	viewport.Height = (float)resolution.y;
@@ -504,10 +849,20 @@ void DirectXDevice::beginFrame()
 
 	ID3D12DescriptorHeap* heaps[] = { cbvSrvUavDescriptorHeap.Get(), samplerDescriptorHeap.Get() };
 	cmdList->SetDescriptorHeaps(2, heaps);
-	cbvSrvUavDescriptorHeapOffset = 0;
-	samplerDescriptorHeapOffset = 0;
+	recordingCmdList = cmdList.Get();
 
-	frameFirstQuery = queryCounter;
+	// The frame fence also covers the extra queues, presentFrame makes the direct queue wait for them
+	for (QueueContext& queue : extraQueues)
+	{
+		queue.cmdAllocators[frameIndex]->Reset();
+		queue.cmdList->Reset(queue.cmdAllocators[frameIndex].Get(), nullptr);
+		if (queue.type != D3D12_COMMAND_LIST_TYPE_COPY)
+			queue.cmdList->SetDescriptorHeaps(2, heaps);
+	}
+
+	cbvSrvUavDescriptorHeapOffset = frameIndex * cbvSrvUavDescriptorsPerFrame;
+	samplerDescriptorHeapOffset = frameIndex * samplerDescriptorsPerFrame;
+	lastDispatchBindings.clear();
 }
 
 void DirectXDevice::dispatch(
@@ -517,18 +872,39 @@ void DirectXDevice::dispatch(
 	std::initializer_list<ID3D12Resource*> cbs,
 	std::initializer_list<const ShaderResourceView*> srvs,
 	std::initializer_list<const UnorderedAccessView*> uavs,
-	std::initializer_list<const SamplerState*> samplers)
+	std::initializer_list<const SamplerState*> samplers,
+	bool uavBarrier)
 {
 	D3D12_CPU_DESCRIPTOR_HANDLE descriptorTablesCpu[D3D12_MAX_ROOT_COST] = {};
-	D3D12_GPU_DESCRIPTOR_HANDLE descriptorTablesGpu[D3D12_MAX_ROOT_COST] = {};
+	std::array<D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_MAX_ROOT_COST> descriptorTablesGpu = {};
+
+	// Same shader and resources as the last dispatch: its descriptor tables are still valid
+	std::vector<const void*> bindings = { shader.getPso() };
+	bindings.insert(bindings.end(), cbs.begin(), cbs.end());
+	bindings.push_back(nullptr);
+	bindings.insert(bindings.end(), srvs.begin(), srvs.end());
+	bindings.push_back(nullptr);
+	bindings.insert(bindings.end(), uavs.begin(), uavs.end());
+	bindings.push_back(nullptr);
+	bindings.insert(bindings.end(), samplers.begin(), samplers.end());
+	bool reuseTables = bindings == lastDispatchBindings;
 
 	const ComputePSO::RootSignatureDesc& rootSigDesc = shader.getRootSignatureDesc();
-	for (size_t rootParamIdx = 0; rootParamIdx < rootSigDesc.size(); rootParamIdx++)
+	for (size_t rootParamIdx = 0; rootParamIdx < rootSigDesc.size() && !reuseTables; rootParamIdx++)
 	{
 		const ComputePSO::RootParameter& rootParam = rootSigDesc[rootParamIdx];
 		if (rootParam.type == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
 		{
 			uint32_t& heapOffset = rootParam.isSamplerDescriptorTable ? samplerDescriptorHeapOffset : cbvSrvUavDescriptorHeapOffset;
+			uint32_t heapEnd = (frameIndex + 1) * (rootParam.isSamplerDescriptorTable ? samplerDescriptorsPerFrame : cbvSrvUavDescriptorsPerFrame);
+			if (heapOffset + rootParam.numDescriptors > heapEnd)
+			{
+				// Also in release builds: the next descriptors belong to a frame the GPU may still be executing
+				printf("\nOut of %s descriptors: more than %u in a frame. Use fewer -content/-placement values.\n",
+					rootParam.isSamplerDescriptorTable ? "sampler" : "CBV/SRV/UAV",
+					rootParam.isSamplerDescriptorTable ? samplerDescriptorsPerFrame : cbvSrvUavDescriptorsPerFrame);
+				exit(1);
+			}
 			uint32_t tableOffset = heapOffset;
 			heapOffset += rootParam.numDescriptors;
 			ID3D12DescriptorHeap* heap = rootParam.isSamplerDescriptorTable ? samplerDescriptorHeap.Get() : cbvSrvUavDescriptorHeap.Get();
@@ -539,9 +915,19 @@ void DirectXDevice::dispatch(
 		}
 	}
 
-	cmdList->SetComputeRootSignature(shader.getRootSignature());
+	if (reuseTables)
+	{
+		descriptorTablesGpu = lastDescriptorTablesGpu;
+	}
+	else
+	{
+		lastDispatchBindings = std::move(bindings);
+		lastDescriptorTablesGpu = descriptorTablesGpu;
+	}
+
+	recordingCmdList->SetComputeRootSignature(shader.getRootSignature());
 
-	auto bindResources = [this, shader, &descriptorTablesCpu]<typename T>(std::initializer_list<T> resources)
+	auto bindResources = [this, shader, reuseTables, &descriptorTablesCpu]<typename T>(std::initializer_list<T> resources)
 	{
 		ComputePSO::EBindingType bindingType = {};
 		if constexpr (std::is_same_v<T, ID3D12Resource*>)
@@ -565,15 +951,26 @@ void DirectXDevice::dispatch(
 			if (binding->isRootDescriptor)
 			{
 				if constexpr (std::is_same_v<T, ID3D12Resource*>)
-					cmdList->SetComputeRootConstantBufferView(binding->rootParamIdx, resource->GetGPUVirtualAddress());
+				{
+					if (binding->num32BitConstants)
+					{
+						const std::vector<unsigned char>& constants = constantBufferData[resource];
+						assert(constants.size() >= binding->num32BitConstants * 4);
+						recordingCmdList->SetComputeRoot32BitConstants(binding->rootParamIdx, binding->num32BitConstants, constants.data(), 0);
+					}
+					else
+					{
+						recordingCmdList->SetComputeRootConstantBufferView(binding->rootParamIdx, resource->GetGPUVirtualAddress());
+					}
+				}
 				else if constexpr (std::is_same_v<T, const ShaderResourceView*>)
-					cmdList->SetComputeRootShaderResourceView(binding->rootParamIdx, resource->resource->GetGPUVirtualAddress());
+					recordingCmdList->SetComputeRootShaderResourceView(binding->rootParamIdx, resource->resource->GetGPUVirtualAddress());
 				else if constexpr (std::is_same_v<T, const UnorderedAccessView*>)
-					cmdList->SetComputeRootUnorderedAccessView(binding->rootParamIdx, resource->resource->GetGPUVirtualAddress());
+					recordingCmdList->SetComputeRootUnorderedAccessView(binding->rootParamIdx, resource->resource->GetGPUVirtualAddress());
 				else
 					static_assert("Unknown type");
 			}
-			else
+			else if (!reuseTables)
 			{
 				uint32_t descriptorSize = device->GetDescriptorHandleIncrementSize(
 					bindingType == ComputePSO::EBindingType::kSampler ? D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER : D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -620,103 +1017,361 @@ void DirectXDevice::dispatch(
 	{
 		const ComputePSO::RootParameter& rootParam = rootSigDesc[rootParamIdx];
 		if (rootParam.type == D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE)
-			cmdList->SetComputeRootDescriptorTable((UINT)rootParamIdx, descriptorTablesGpu[rootParamIdx]);
+			recordingCmdList->SetComputeRootDescriptorTable((UINT)rootParamIdx, descriptorTablesGpu[rootParamIdx]);
 	}
 
-	cmdList->SetPipelineState(shader.getPso());
+	recordingCmdList->SetPipelineState(shader.getPso());
 	uint3 groups = divRoundUp(resolution, groupSize);
-	cmdList->Dispatch(groups.x, groups.y, groups.z);
+	recordingCmdList->Dispatch(groups.x, groups.y, groups.z);
+
+	// Without the barrier consecutive dispatches are allowed to overlap on the GPU
+	if (uavBarrier)
+	{
+		D3D12_RESOURCE_BARRIER barrier =
+		{
+			.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV
+		};
+		recordingCmdList->ResourceBarrier(1, &barrier);
+	}
+}
 
+void DirectXDevice::transitionResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after)
+{
 	D3D12_RESOURCE_BARRIER barrier =
 	{
-		.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV
+		.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+		.Transition =
+		{
+			.pResource = resource,
+			.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+			.StateBefore = before,
+			.StateAfter = after
+		}
 	};
-	cmdList->ResourceBarrier(1, &barrier);
+	recordingCmdList->ResourceBarrier(1, &barrier);
+}
+
+void DirectXDevice::copyBuffer(ID3D12Resource* dst, unsigned dstOffset, ID3D12Resource* src, unsigned srcOffset, unsigned bytes)
+{
+	recordingCmdList->CopyBufferRegion(dst, dstOffset, src, srcOffset, bytes);
 }
 
 void DirectXDevice::presentFrame()
 {
-	uint32_t firstIdx = frameFirstQuery % queries.size();
-	uint32_t remain = queryCounter - frameFirstQuery;
-	while (remain)
+	FrameContext& frame = frames[frameIndex];
+	if (frame.numQueries)
 	{
-		uint32_t num = remain;
-		if (firstIdx + remain > queries.size())
-			num = queries.size() - firstIdx;
-
 		cmdList->ResolveQueryData(
 			queryHeap.Get(),
 			D3D12_QUERY_TYPE_TIMESTAMP,
-			firstIdx * 2,
-			num * 2,
-			queryResultBuffer.Get(),
-			firstIdx * sizeof(uint64_t) * 2);
+			frameIndex * maxQueriesPerFrame * 2,
+			frame.numQueries * 2,
+			frame.queryResultBuffer.Get(),
+			0);
 
-		firstIdx = (firstIdx + num) % queries.size();
-		remain -= num;
+		if (pipelineStatisticsQueryHeap)
+		{
+			cmdList->ResolveQueryData(
+				pipelineStatisticsQueryHeap.Get(),
+				D3D12_QUERY_TYPE_PIPELINE_STATISTICS,
+				frameIndex * maxQueriesPerFrame,
+				frame.numQueries,
+				frame.pipelineStatisticsResultBuffer.Get(),
+				0);
+		}
 	}
 	cmdList->Close();
 
+	uint64_t submitStart = 0;
+	if (timeline)
+	{
+		submitStart = TimelineTrace::cpuTimestamp();
+		timeline->addCpuSpan("Record", frameCounter, frame.recordStart, submitStart);
+	}
+
+	for (QueueContext& queue : extraQueues)
+	{
+		queue.cmdList->Close();
+		auto extraCmdList = (ID3D12CommandList*)queue.cmdList.Get();
+		queue.queue->ExecuteCommandLists(1, &extraCmdList);
+		queue.queue->Signal(queue.fence.Get(), ++queue.fenceValue);
+		cmdQueue->Wait(queue.fence.Get(), queue.fenceValue);
+	}
+
 	auto cmdListToSubmit = (ID3D12CommandList*)cmdList.Get();
 	cmdQueue->ExecuteCommandLists(1, &cmdListToSubmit);
 
 	const bool vsync = false;
 	swapChain->Present(vsync ? 1 : 0, 0);
 
-	cmdQueue->Signal(fence.Get(), ++fenceLastSignalVal);
-	HRESULT hr = fence->SetEventOnCompletion(fenceLastSignalVal, fenceEvent);
-	assert(SUCCEEDED(hr));
-	WaitForSingleObject(fenceEvent, INFINITE);
+	// Don't wait here. beginFrame blocks only when it needs to reuse a frame the GPU is still executing.
+	frame.fenceValue = ++fenceLastSignalVal;
+	cmdQueue->Signal(fence.Get(), frame.fenceValue);
+	frame.resultsPending = frame.numQueries > 0;
+	if (timeline)
+		timeline->addCpuSpan("Submit and present", frameCounter, submitStart, TimelineTrace::cpuTimestamp());
+
+	frameIndex = (frameIndex + 1) % numFramesInFlight;
+	frameCounter++;
+}
+
+unsigned DirectXDevice::addQueue(D3D12_COMMAND_LIST_TYPE type)
+{
+	QueueContext queue = { .type = type };
+	D3D12_COMMAND_QUEUE_DESC queueDesc =
+	{
+		.Type = type,
+		.NodeMask = 1
+	};
+	HRESULT result = device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(queue.queue.GetAddressOf()));
+	assert(SUCCEEDED(result));
+
+	result = device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(queue.fence.GetAddressOf()));
+	assert(SUCCEEDED(result));
+
+	for (ComPtr<ID3D12CommandAllocator>& cmdAllocator : queue.cmdAllocators)
+	{
+		result = device->CreateCommandAllocator(type, IID_PPV_ARGS(cmdAllocator.GetAddressOf()));
+		assert(SUCCEEDED(result));
+	}
+
+	result = device->CreateCommandList(
+		0,
+		type,
+		queue.cmdAllocators[0].Get(),
+		nullptr,
+		IID_PPV_ARGS(queue.cmdList.GetAddressOf()));
+	assert(SUCCEEDED(result));
+	queue.cmdList->Close();
+
+	extraQueues.push_back(queue);
+	return (unsigned)extraQueues.size();
+}
+
+void DirectXDevice::setRecordingQueue(unsigned queue)
+{
+	assert(queue <= extraQueues.size());
+	recordingCmdList = queue ? extraQueues[queue - 1].cmdList.Get() : cmdList.Get();
+}
+
+// Splits the frame: the commands recorded so far are executed and recording continues in the same list.
+// The allocator stays the same, it's reset by the beginFrame that reuses this frame.
+SyncPoint DirectXDevice::submit(unsigned queue)
+{
+	assert(queue <= extraQueues.size());
+	ID3D12DescriptorHeap* heaps[] = { cbvSrvUavDescriptorHeap.Get(), samplerDescriptorHeap.Get() };
+	uint64_t submitStart = timeline ? TimelineTrace::cpuTimestamp() : 0;
+	if (queue == 0)
+	{
+		cmdList->Close();
+		auto cmdListToSubmit = (ID3D12CommandList*)cmdList.Get();
+		cmdQueue->ExecuteCommandLists(1, &cmdListToSubmit);
+		cmdQueue->Signal(fence.Get(), ++fenceLastSignalVal);
+		if (timeline)
+			timeline->addCpuSpan("Submit", frameCounter, submitStart, TimelineTrace::cpuTimestamp());
+
+		cmdList->Reset(frames[frameIndex].cmdAllocator.Get(), nullptr);
+		cmdList->SetDescriptorHeaps(2, heaps);
+		return { queue, fenceLastSignalVal };
+	}
+
+	QueueContext& context = extraQueues[queue - 1];
+	context.cmdList->Close();
+	auto cmdListToSubmit = (ID3D12CommandList*)context.cmdList.Get();
+	context.queue->ExecuteCommandLists(1, &cmdListToSubmit);
+	context.queue->Signal(context.fence.Get(), ++context.fenceValue);
+	if (timeline)
+		timeline->addCpuSpan("Submit", frameCounter, submitStart, TimelineTrace::cpuTimestamp());
+
+	context.cmdList->Reset(context.cmdAllocators[frameIndex].Get(), nullptr);
+	if (context.type != D3D12_COMMAND_LIST_TYPE_COPY)
+		context.cmdList->SetDescriptorHeaps(2, heaps);
+	return { queue, context.fenceValue };
+}
+
+// Commands submitted to the queue after this call start once the sync point is reached
+void DirectXDevice::waitForSyncPoint(unsigned queue, SyncPoint syncPoint)
+{
+	ID3D12CommandQueue* waitingQueue = queue ? extraQueues[queue - 1].queue.Get() : cmdQueue.Get();
+	ID3D12Fence* syncFence = syncPoint.queue ? extraQueues[syncPoint.queue - 1].fence.Get() : fence.Get();
+	waitingQueue->Wait(syncFence, syncPoint.fenceValue);
+}
+
+// Optional pipeline statistics queries around every performance query. Returns false if the driver doesn't
+// support them, in which case only timestamps are collected.
+bool DirectXDevice::enablePipelineStatistics()
+{
+	if (pipelineStatisticsQueryHeap)
+		return true;
+
+	D3D12_QUERY_HEAP_DESC queryHeapDesc = {
+		.Type = D3D12_QUERY_HEAP_TYPE_PIPELINE_STATISTICS,
+		.Count = numFramesInFlight * maxQueriesPerFrame };
+	HRESULT result = device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(pipelineStatisticsQueryHeap.GetAddressOf()));
+	if (FAILED(result))
+		return false;
+
+	D3D12_RESOURCE_DESC resourceDesc = InitBufferResourceDesc(maxQueriesPerFrame * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS));
+	D3D12_HEAP_PROPERTIES heapProps = { .Type = D3D12_HEAP_TYPE_READBACK };
+	for (FrameContext& frame : frames)
+	{
+		result = device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&resourceDesc,
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr,
+			IID_PPV_ARGS(frame.pipelineStatisticsResultBuffer.GetAddressOf()));
+		if (FAILED(result))
+		{
+			pipelineStatisticsQueryHeap.Reset();
+			return false;
+		}
+	}
+
+	return true;
 }
 
-QueryHandle DirectXDevice::startPerformanceQuery(unsigned id, const std::string& name)
+QueryHandle DirectXDevice::startPerformanceQuery(unsigned id, const std::string& name, bool spansSubmits)
 {
-	PIXBeginEvent(cmdList.Get(), 0xffff00ff, name.c_str());
+	// Events and pipeline statistics queries must begin and end in the same command list
+	if (spansSubmits)
+		markerSet(cmdList.Get(), MARKER_COLOR(255, 0, 255), name.c_str());
+	else
+		markerBegin(cmdList.Get(), MARKER_COLOR(255, 0, 255), name.c_str());
 	
-	uint32_t queryIndex = queryCounter % queries.size();
-	PerformanceQuery& query = queries[queryIndex];
+	// Also in release builds: the next query range belongs to a frame whose results haven't been read back
+	FrameContext& frame = frames[frameIndex];
+	if (frame.numQueries >= maxQueriesPerFrame)
+	{
+		printf("\nMore than %u performance queries in a frame. Use fewer -content/-placement values.\n", maxQueriesPerFrame);
+		exit(1);
+	}
+	uint32_t queryIndex = frame.numQueries++;
+	PerformanceQuery& query = frame.queries[queryIndex];
 	
 	query.id = id;
 	query.name = name;
+	query.spansSubmits = spansSubmits;
+	query.pipelineStatistics = pipelineStatisticsQueryHeap && !spansSubmits;
+
+	// Pipeline statistics bracket the timestamps, so their begin and end don't add to the timed range
+	if (query.pipelineStatistics)
+		cmdList->BeginQuery(pipelineStatisticsQueryHeap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, frameIndex * maxQueriesPerFrame + queryIndex);
 
-	cmdList->EndQuery(queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryIndex * 2);
+	cmdList->EndQuery(queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, (frameIndex * maxQueriesPerFrame + queryIndex) * 2);
 
-	return {queryCounter++};
+	return {queryIndex};
 }
 
 void DirectXDevice::endPerformanceQuery(QueryHandle queryHandle)
 {
+	const PerformanceQuery& query = frames[frameIndex].queries[queryHandle.queryIndex];
 	cmdList->EndQuery(
 		queryHeap.Get(),
 		D3D12_QUERY_TYPE_TIMESTAMP,
-		(queryHandle.queryIndex % queries.size()) * 2 + 1);
+		(frameIndex * maxQueriesPerFrame + queryHandle.queryIndex) * 2 + 1);
+
+	unsigned statisticsIndex = frameIndex * maxQueriesPerFrame + queryHandle.queryIndex;
+	if (pipelineStatisticsQueryHeap && !query.pipelineStatistics)
+	{
+		// Empty query, every slot of the resolved range must have ended
+		cmdList->BeginQuery(pipelineStatisticsQueryHeap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, statisticsIndex);
+		cmdList->EndQuery(pipelineStatisticsQueryHeap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, statisticsIndex);
+	}
+	else if (pipelineStatisticsQueryHeap)
+	{
+		cmdList->EndQuery(pipelineStatisticsQueryHeap.Get(), D3D12_QUERY_TYPE_PIPELINE_STATISTICS, statisticsIndex);
+	}
 
-	PIXEndEvent(cmdList.Get());
+	if (!query.spansSubmits)
+		markerEnd(cmdList.Get());
 }
 
-void DirectXDevice::processPerformanceResults(const std::function<void(float, unsigned, std::string&)>& functor)
+void DirectXDevice::processPerformanceResults(const std::function<void(const PerformanceResult&)>& functor)
 {
-	uint64_t* results = nullptr;
-	HRESULT hr = queryResultBuffer->Map(0, nullptr, (void**)&results);
-	assert(SUCCEEDED(hr));
+	// The next beginFrame reuses the oldest frame. Wait for it here (beginFrame would block on it anyway),
+	// so its results are read back before the query range gets overwritten.
+	waitForFence(frames[frameIndex].fenceValue);
 
 	uint64_t frequency;
-	hr = cmdQueue->GetTimestampFrequency(&frequency);
+	HRESULT hr = cmdQueue->GetTimestampFrequency(&frequency);
 	assert(SUCCEEDED(hr));
 
-	for (uint32_t idx = frameFirstQuery; idx < queryCounter; idx++)
+	UINT64 completedFenceValue = fence->GetCompletedValue();
+	if (timeline)
+		calibrateTimeline();
+
+	// Oldest frame first, so results are reported in submission order
+	for (unsigned i = 0; i < numFramesInFlight; i++)
 	{
-		uint32_t queryIdx = idx % queries.size();
-		PerformanceQuery& query = queries[queryIdx];
-		uint64_t start = results[queryIdx * 2];
-		uint64_t end = results[queryIdx * 2 + 1];
+		FrameContext& frame = frames[(frameIndex + i) % numFramesInFlight];
+		if (!frame.resultsPending || frame.fenceValue > completedFenceValue)
+			continue;
 
-		UINT64 d = end - start;
-		float delta = (float(d) / float(frequency)) * 1000.0f;
+		uint64_t* results = nullptr;
+		D3D12_RANGE readRange = { 0, frame.numQueries * 2 * sizeof(uint64_t) };
+		hr = frame.queryResultBuffer->Map(0, &readRange, (void**)&results);
+		assert(SUCCEEDED(hr));
+
+		D3D12_QUERY_DATA_PIPELINE_STATISTICS* pipelineStatistics = nullptr;
+		if (pipelineStatisticsQueryHeap)
+		{
+			D3D12_RANGE statisticsRange = { 0, frame.numQueries * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS) };
+			hr = frame.pipelineStatisticsResultBuffer->Map(0, &statisticsRange, (void**)&pipelineStatistics);
+			assert(SUCCEEDED(hr));
+		}
+
+		for (uint32_t queryIdx = 0; queryIdx < frame.numQueries; queryIdx++)
+		{
+			PerformanceQuery& query = frame.queries[queryIdx];
+			uint64_t start = results[queryIdx * 2];
+			uint64_t end = results[queryIdx * 2 + 1];
+
+			if (timeline)
+				timeline->addGpuSpan(query.name, frame.frameNumber, start, end);
+
+			UINT64 d = end - start;
+			float delta = (float(d) / float(frequency)) * 1000.0f;
+
+			// Call functor to process results
+			functor({
+				.id = query.id,
+				.name = query.name,
+				.frame = frame.frameNumber,
+				.timeMillis = delta,
+				.gpuStart = start,
+				.gpuEnd = end,
+				.pipelineStatistics = query.pipelineStatistics ? &pipelineStatistics[queryIdx] : nullptr });
+		}
 
-		// Call functor to process results
-		functor(delta, query.id, query.name);
+		D3D12_RANGE writeRange = {};
+		frame.queryResultBuffer->Unmap(0, &writeRange);
+		if (pipelineStatistics)
+			frame.pipelineStatisticsResultBuffer->Unmap(0, &writeRange);
+		frame.resultsPending = false;
 	}
+}
 
-	queryResultBuffer->Unmap(0, nullptr);
+void DirectXDevice::setTimeline(TimelineTrace* newTimeline)
+{
+	timeline = newTimeline;
+	if (timeline)
+		calibrateTimeline();
+}
+
+bool DirectXDevice::getClockCalibration(uint64_t& gpuTimestamp, uint64_t& cpuTimestamp, uint64_t& gpuFrequency)
+{
+	HRESULT hr = cmdQueue->GetTimestampFrequency(&gpuFrequency);
+	assert(SUCCEEDED(hr));
+	hr = cmdQueue->GetClockCalibration(&gpuTimestamp, &cpuTimestamp);
+	return SUCCEEDED(hr);
+}
+
+// A GPU and CPU timestamp pair. Sampled every frame, the GPU and CPU clocks drift apart over a run.
+void DirectXDevice::calibrateTimeline()
+{
+	uint64_t gpuTimestamp, cpuTimestamp, frequency;
+	if (getClockCalibration(gpuTimestamp, cpuTimestamp, frequency))
+		timeline->addCalibration(gpuTimestamp, cpuTimestamp, frequency);
 }
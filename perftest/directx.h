@@ -24,6 +24,26 @@ struct PerformanceQuery
 {
 	unsigned id;
 	std::string name;
+	bool spansSubmits;
+	bool pipelineStatistics;
+};
+
+// Fence value signaled by a queue after a submit
+struct SyncPoint
+{
+	unsigned queue;
+	UINT64 fenceValue;
+};
+
+struct PerformanceResult
+{
+	unsigned id;
+	const std::string& name;
+	unsigned frame;			// Frame number the query was recorded in
+	float timeMillis;
+	uint64_t gpuStart;		// Raw GPU timestamps of the query, in ticks of the direct queue timestamp frequency
+	uint64_t gpuEnd;
+	const D3D12_QUERY_DATA_PIPELINE_STATISTICS* pipelineStatistics;		// Null if not enabled
 };
 
 class SamplerState
@@ -69,6 +89,7 @@ public:
 		uint32_t rootParamIdx;
 		bool isRootDescriptor;
 		uint32_t descriptorOffset;
+		uint32_t num32BitConstants = 0;		// Root constants, set from the CPU copy of the constant buffer
 	};
 
 	enum class EBindingType
@@ -96,15 +117,30 @@ public:
 	ID3D12RootSignature* getRootSignature() const { return rootSig.Get(); }
 	const RootSignatureDesc& getRootSignatureDesc() const { return rootSignatureDesc; }
 	const Binding* getBinding(uint32_t slot, EBindingType type) const;
+	const std::string& getName() const { return name; }
 
 private:
+	std::string name;
 	ComPtr<ID3D12PipelineState> pso;
 	ComPtr<ID3D12RootSignature> rootSig;
 	RootSignatureDesc rootSignatureDesc;
 	std::unordered_map<uint32_t, Binding> bindings[(int)EBindingType::kCount];
 };
 
+// Memory of a resource. Resources with a heap are placed at heapOffset, others are committed resources
+// in a heap with heapProperties.
+struct ResourcePlacement
+{
+	D3D12_HEAP_PROPERTIES heapProperties = { .Type = D3D12_HEAP_TYPE_DEFAULT };
+	ID3D12Heap* heap = nullptr;
+	UINT64 heapOffset = 0;
+	UINT64 alignment = 0;		// Resource alignment. Small textures can be placed at 4KB.
+};
+
+class TimelineTrace;
+
 std::vector<ComPtr<IDXGIAdapter>> enumerateAdapters();
+unsigned getFormatBytes(DXGI_FORMAT format);
 
 class DirectXDevice
 {
@@ -116,6 +152,13 @@ public:
 		Trilinear
 	};
 
+	// Frames recorded ahead of the GPU. Keeps the GPU busy (and clocks steady) between frames.
+	static constexpr unsigned numFramesInFlight = 3;
+	static constexpr unsigned maxQueriesPerFrame = 4096;
+	static constexpr unsigned cbvSrvUavDescriptorsPerFrame = 100'000;
+	static constexpr unsigned samplerDescriptorsPerFrame = 2048 / numFramesInFlight;	// Shader visible sampler heap limit
+	static constexpr unsigned maxBindlessDescriptors = 1024;		// Persistent, at the end of the CBV/SRV/UAV heap
+
 	DirectXDevice(HWND window, uint2 resolution, IDXGIAdapter* adapter = nullptr);
 	~DirectXDevice();
 
@@ -123,11 +166,19 @@ public:
 	ComputePSO createComputeShader(const std::string& name, const std::vector<unsigned char>& shaderBytes);
 
 	ComPtr<ID3D12Resource> createConstantBuffer(unsigned bytes);
-	ComPtr<ID3D12Resource> createBuffer(unsigned numElements, unsigned strideBytes);
-	ComPtr<ID3D12Resource> createTexture2d(uint2 dimensions, DXGI_FORMAT format, unsigned mips);
+	ComPtr<ID3D12Resource> createUploadBuffer(unsigned bytes);
+	ComPtr<ID3D12Resource> createReadbackBuffer(unsigned bytes);
+	ComPtr<ID3D12Resource> createBuffer(unsigned numElements, unsigned strideBytes, const ResourcePlacement& placement = {});
+	ComPtr<ID3D12Resource> createTexture2d(uint2 dimensions, DXGI_FORMAT format, unsigned mips, const ResourcePlacement& placement = {});
 	ComPtr<ID3D12Resource> createTexture3d(uint3 dimensions, DXGI_FORMAT format, unsigned mips);
 	SamplerState createSampler(SamplerType type);
 
+	// Explicit heaps for placed resources. Resources in CPU visible heaps don't get the UAV flag.
+	// Resource creation returns null if a non-default placement isn't supported.
+	ComPtr<ID3D12Heap> createHeap(UINT64 bytes, D3D12_HEAP_FLAGS flags, UINT64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	D3D12_HEAP_PROPERTIES getCustomHeapProperties(D3D12_HEAP_TYPE type);
+	D3D12_RESOURCE_ALLOCATION_INFO getTexture2dAllocationInfo(uint2 dimensions, DXGI_FORMAT format, unsigned mips, UINT64 alignment);
+
 	UnorderedAccessView createUAV(ID3D12Resource* resource);
 	UnorderedAccessView createTypedUAV(ID3D12Resource* buffer, unsigned numElements, DXGI_FORMAT format);
 	UnorderedAccessView createByteAddressUAV(ID3D12Resource* buffer, unsigned numElements);
@@ -137,16 +188,35 @@ public:
 	ShaderResourceView createStructuredSRV(ID3D12Resource* buffer, unsigned numElements, unsigned stride);
 	ShaderResourceView createByteAddressSRV(ID3D12Resource* buffer, unsigned numElements);
 
-	// Data update
+	// Shader model 6.6 ResourceDescriptorHeap access. createBindlessSRV writes count consecutive copies of
+	// the view into the persistent heap range and returns the heap index of the first one.
+	bool supportsBindless();
+	unsigned createBindlessSRV(const ShaderResourceView& view, unsigned count);
+
+	// Shader model 6.2 native 16-bit types, and 64-bit integers
+	bool supports16BitTypes();
+	bool supportsInt64();
+
+	// Lanes per wave. Adapters with a variable wave size report the maximum.
+	unsigned getWaveLaneCount();
+
+	// Data update. A CPU copy is kept for the shaders that take the constants as root constants.
+	void updateConstantBuffer(ID3D12Resource* cbuffer, const void* data, unsigned bytes);
 	template <typename T>
 	void updateConstantBuffer(ID3D12Resource* cbuffer, const T& cb)
 	{
-		void* ptr = nullptr;
-		cbuffer->Map(0, nullptr, &ptr);
-		memcpy(ptr, &cb, sizeof(cb));
-		cbuffer->Unmap(0, nullptr);
+		updateConstantBuffer(cbuffer, &cb, sizeof(cb));
 	}
 
+	// CPU access to upload and readback heap buffers
+	void writeBuffer(ID3D12Resource* uploadBuffer, const void* data, unsigned bytes);
+	void readBuffer(ID3D12Resource* readbackBuffer, void* data, unsigned bytes);
+
+	// Copies data to a default heap resource through a staging buffer. Blocks until the copy is done.
+	// Resources in CPU visible heaps are written directly.
+	void uploadBuffer(ID3D12Resource* buffer, const void* data, unsigned bytes);
+	void uploadTexture2d(ID3D12Resource* texture, const void* data);		// Tightly packed rows
+
 	// Commands
 	void beginFrame();
 	void dispatch(
@@ -156,21 +226,68 @@ public:
 		std::initializer_list<ID3D12Resource*> cbs,
 		std::initializer_list<const ShaderResourceView*> srvs,
 		std::initializer_list<const UnorderedAccessView*> uavs = {},
-		std::initializer_list<const SamplerState*> samplers = {});
+		std::initializer_list<const SamplerState*> samplers = {},
+		bool uavBarrier = true);
+	void transitionResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after);
+	void copyBuffer(ID3D12Resource* dst, unsigned dstOffset, ID3D12Resource* src, unsigned srcOffset, unsigned bytes);
 	void presentFrame();
+	void waitForIdle();
 
-	// Performance querys
-	QueryHandle startPerformanceQuery(unsigned id, const std::string& name);
+	// Additional compute and copy queues. Queue 0 is the direct queue. Add queues outside of a frame.
+	unsigned addQueue(D3D12_COMMAND_LIST_TYPE type);
+	void setRecordingQueue(unsigned queue);		// Commands go to this queue until the next beginFrame
+	SyncPoint submit(unsigned queue);			// Executes the commands recorded so far
+	void waitForSyncPoint(unsigned queue, SyncPoint syncPoint);		// GPU side wait
+
+	// Performance querys. Queries spanning a submit are timestamps only.
+	bool enablePipelineStatistics();
+	QueryHandle startPerformanceQuery(unsigned id, const std::string& name, bool spansSubmits = false);
 	void endPerformanceQuery(QueryHandle queryHandle);
-	void processPerformanceResults(const std::function<void(float, unsigned, std::string&)>& functor);
+	void processPerformanceResults(const std::function<void(const PerformanceResult&)>& functor);
+
+	// GPU timestamp of the direct queue and CPU QueryPerformanceCounter sampled at the same time
+	bool getClockCalibration(uint64_t& gpuTimestamp, uint64_t& cpuTimestamp, uint64_t& gpuFrequency);
+
+	// Records frame recording, submit and fence wait spans, the query results and GPU clock calibrations
+	// into the timeline until it's set to null
+	void setTimeline(TimelineTrace* timeline);
 
 	// Device and window
 	HWND getWindowHandle() { return windowHandle; }
 	uint2 getResolution() { return resolution; }
 	ID3D12Device* getDevice() { return device.Get(); }
 	ID3D12GraphicsCommandList* getCmdList() { return cmdList.Get(); }
+	ID3D12CommandQueue* getCmdQueue() { return cmdQueue.Get(); }
 
 private:
+	struct FrameContext
+	{
+		ComPtr<ID3D12CommandAllocator> cmdAllocator;
+		ComPtr<ID3D12Resource> queryResultBuffer;
+		ComPtr<ID3D12Resource> pipelineStatisticsResultBuffer;
+		std::vector<PerformanceQuery> queries;		// maxQueriesPerFrame
+		unsigned numQueries = 0;
+		unsigned frameNumber = 0;
+		UINT64 fenceValue = 0;
+		bool resultsPending = false;
+		uint64_t recordStart = 0;		// Timeline CPU timestamp of beginFrame
+	};
+
+	struct QueueContext
+	{
+		D3D12_COMMAND_LIST_TYPE type;
+		ComPtr<ID3D12CommandQueue> queue;
+		std::array<ComPtr<ID3D12CommandAllocator>, numFramesInFlight> cmdAllocators;
+		ComPtr<ID3D12GraphicsCommandList> cmdList;
+		ComPtr<ID3D12Fence> fence;
+		UINT64 fenceValue = 0;
+	};
+
+	void waitForFence(UINT64 fenceValue);
+	void calibrateTimeline();
+	bool supportsShaderModel(D3D_SHADER_MODEL shaderModel);
+	ComPtr<ID3D12Resource> createResource(const D3D12_RESOURCE_DESC& desc, const ResourcePlacement& placement);
+	void executeImmediate(const std::function<void(ID3D12GraphicsCommandList*)>& record);
 
 	// Window
 	HWND windowHandle;
@@ -185,16 +302,30 @@ private:
 	HANDLE fenceEvent;
 	UINT64 fenceLastSignalVal;
 	ComPtr<ID3D12GraphicsCommandList> cmdList;
-	ComPtr<ID3D12CommandAllocator> cmdAllocator;
+	ID3D12GraphicsCommandList* recordingCmdList = nullptr;
+	std::vector<QueueContext> extraQueues;		// Queue index - 1
+	ComPtr<ID3D12CommandAllocator> immediateCmdAllocator;		// Resource uploads outside of frames
+	ComPtr<ID3D12GraphicsCommandList> immediateCmdList;
 	ComPtr<ID3D12QueryHeap> queryHeap;
-	ComPtr<ID3D12Resource> queryResultBuffer;
+	ComPtr<ID3D12QueryHeap> pipelineStatisticsQueryHeap;
 	ComPtr<ID3D12DescriptorHeap> cbvSrvUavDescriptorHeap;
 	ComPtr<ID3D12DescriptorHeap> samplerDescriptorHeap;
 	uint32_t cbvSrvUavDescriptorHeapOffset = 0;
 	uint32_t samplerDescriptorHeapOffset = 0;
 
-	// Queries
-	std::array<PerformanceQuery, 4096> queries;
-	unsigned queryCounter = 0;
-	unsigned frameFirstQuery = 0;
+	// Descriptor tables of the last dispatch. Dispatches with the same shader and resources reuse them, so batches
+	// and repetitions don't use up the descriptors of the frame.
+	std::vector<const void*> lastDispatchBindings;
+	std::array<D3D12_GPU_DESCRIPTOR_HANDLE, D3D12_MAX_ROOT_COST> lastDescriptorTablesGpu = {};
+	std::unordered_map<ID3D12Resource*, std::vector<unsigned char>> constantBufferData;		// Root constants
+	uint32_t bindlessDescriptorsStart = 0;
+	uint32_t numBindlessDescriptors = 0;
+
+	// Frames in flight. Each frame owns a command allocator, a query range, a readback buffer
+	// and a descriptor heap range, so the CPU can record frame N+1 while the GPU executes frame N.
+	std::array<FrameContext, numFramesInFlight> frames;
+	unsigned frameIndex = 0;
+	unsigned frameCounter = 0;
+
+	TimelineTrace* timeline = nullptr;
 };
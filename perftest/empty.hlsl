@@ -0,0 +1,8 @@
+// Empty kernel for measuring the fixed cost of a dispatch
+#define ROOT_SIGNATURE "RootFlags(0)"
+
+[RootSignature(ROOT_SIGNATURE)]
+[numthreads(256, 1, 1)]
+void main()
+{
+}
@@ -28,3 +28,15 @@ std::vector<unsigned char> loadFile(const std::string& filename)
 
 	return outVec;
 }
+
+long getFileSize(const std::string& filename)
+{
+	FILE *f = nullptr;
+	fopen_s(&f, filename.c_str(), "rb");
+	if (!f)
+		return 0;
+
+	long size = fileSize(f);
+	fclose(f);
+	return size;
+}
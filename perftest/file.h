@@ -4,3 +4,6 @@
 #include <string>
 
 std::vector<unsigned char> loadFile(const std::string& filename);
+
+// 0 if the file can't be opened
+long getFileSize(const std::string& filename);
@@ -0,0 +1,77 @@
+#include "gpuMarkers.h"
+#include "timelineTrace.h"
+#include <cstring>
+
+#if GPU_MARKERS == GPU_MARKERS_PIX
+#define USE_PIX 1
+#include <pix3.h>
+#endif
+
+#if GPU_MARKERS == GPU_MARKERS_D3D12
+// Event metadata of an ANSI string (WINPIX_EVENT_ANSI_VERSION)
+static const UINT markerAnsiMetadata = 1;
+#endif
+
+#if GPU_MARKERS == GPU_MARKERS_RING
+// Fixed size, records are written in place. Holds the markers of a few hundred frames.
+static const unsigned markerRingSize = 1 << 16;
+static std::vector<MarkerRecord> markerRing(markerRingSize);
+static uint64_t markerRingWrites = 0;
+static uint8_t markerDepth = 0;
+
+static void pushMarker(MarkerRecord::Type type, uint8_t depth, uint32_t color, const char* name)
+{
+	MarkerRecord& record = markerRing[markerRingWrites++ % markerRingSize];
+	record.type = type;
+	record.depth = depth;
+	record.color = color;
+	record.cpuTimestamp = TimelineTrace::cpuTimestamp();
+	strncpy_s(record.name, name, _TRUNCATE);
+}
+#endif
+
+#if GPU_MARKERS != GPU_MARKERS_NONE
+void markerBegin(ID3D12GraphicsCommandList* cmdList, uint32_t color, const char* name)
+{
+#if GPU_MARKERS == GPU_MARKERS_PIX
+	PIXBeginEvent(cmdList, color, name);
+#elif GPU_MARKERS == GPU_MARKERS_D3D12
+	cmdList->BeginEvent(markerAnsiMetadata, name, (UINT)strlen(name) + 1);
+#elif GPU_MARKERS == GPU_MARKERS_RING
+	pushMarker(MarkerRecord::Type::Begin, markerDepth++, color, name);
+#endif
+}
+
+void markerEnd(ID3D12GraphicsCommandList* cmdList)
+{
+#if GPU_MARKERS == GPU_MARKERS_PIX
+	PIXEndEvent(cmdList);
+#elif GPU_MARKERS == GPU_MARKERS_D3D12
+	cmdList->EndEvent();
+#elif GPU_MARKERS == GPU_MARKERS_RING
+	pushMarker(MarkerRecord::Type::End, --markerDepth, 0, "");
+#endif
+}
+
+void markerSet(ID3D12GraphicsCommandList* cmdList, uint32_t color, const char* name)
+{
+#if GPU_MARKERS == GPU_MARKERS_PIX
+	PIXSetMarker(cmdList, color, name);
+#elif GPU_MARKERS == GPU_MARKERS_D3D12
+	cmdList->SetMarker(markerAnsiMetadata, name, (UINT)strlen(name) + 1);
+#elif GPU_MARKERS == GPU_MARKERS_RING
+	pushMarker(MarkerRecord::Type::Set, markerDepth, color, name);
+#endif
+}
+#endif
+
+std::vector<MarkerRecord> readMarkerRing()
+{
+	std::vector<MarkerRecord> records;
+#if GPU_MARKERS == GPU_MARKERS_RING
+	uint64_t first = markerRingWrites > markerRingSize ? markerRingWrites - markerRingSize : 0;
+	for (uint64_t i = first; i < markerRingWrites; i++)
+		records.push_back(markerRing[i % markerRingSize]);
+#endif
+	return records;
+}
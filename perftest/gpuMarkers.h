@@ -0,0 +1,52 @@
+#pragma once
+#include <d3d12.h>
+#include <cstdint>
+#include <vector>
+
+// Named and colored debug markers of the command lists, nested with markerBegin/markerEnd. Every backend
+// gets the same calls, so captures show the same structure. The backend is picked at compile time:
+//   GPU_MARKERS_NONE   markers compile out, for measurement builds
+//   GPU_MARKERS_PIX    WinPixEventRuntime events (PIX, RenderDoc), Debug builds of perftest.vcxproj
+//   GPU_MARKERS_D3D12  plain ID3D12GraphicsCommandList events with ANSI strings, no WinPixEventRuntime, the default
+//   GPU_MARKERS_RING   CPU side ring buffer of marker records, read with readMarkerRing
+#define GPU_MARKERS_NONE 0
+#define GPU_MARKERS_PIX 1
+#define GPU_MARKERS_D3D12 2
+#define GPU_MARKERS_RING 3
+
+// perftest.vcxproj defines GPU_MARKERS per configuration (GpuMarkers property), release builds have no markers
+#ifndef GPU_MARKERS
+#define GPU_MARKERS GPU_MARKERS_D3D12
+#endif
+
+#define MARKER_COLOR(r, g, b) (0xff000000u | ((uint32_t)(r) << 16) | ((uint32_t)(g) << 8) | (uint32_t)(b))
+
+struct MarkerRecord
+{
+	enum class Type : uint8_t
+	{
+		Begin,
+		End,
+		Set
+	};
+
+	Type type;
+	uint8_t depth;				// Nesting depth. An end has the depth of its begin.
+	uint32_t color;				// ARGB
+	uint64_t cpuTimestamp;		// TimelineTrace::cpuTimestamp when recorded
+	char name[48];				// Truncated, empty for an end
+};
+
+#if GPU_MARKERS == GPU_MARKERS_NONE
+inline void markerBegin(ID3D12GraphicsCommandList*, uint32_t, const char*) {}
+inline void markerEnd(ID3D12GraphicsCommandList*) {}
+inline void markerSet(ID3D12GraphicsCommandList*, uint32_t, const char*) {}
+#else
+void markerBegin(ID3D12GraphicsCommandList* cmdList, uint32_t color, const char* name);
+void markerEnd(ID3D12GraphicsCommandList* cmdList);
+void markerSet(ID3D12GraphicsCommandList* cmdList, uint32_t color, const char* name);
+#endif
+
+// Ring buffer records, oldest first. The oldest are overwritten once the ring is full. Empty unless
+// GPU_MARKERS is GPU_MARKERS_RING.
+std::vector<MarkerRecord> readMarkerRing();
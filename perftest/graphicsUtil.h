@@ -8,3 +8,9 @@ inline ComputePSO loadComputeShader(DirectXDevice &dx, const std::string &filena
 	return dx.createComputeShader(filename, shaderBlob);
 }
 
+// Shader model 6.x kernels are only built by compile_shaders_6_0.bat
+inline bool isShaderCompiled(const std::string &filename)
+{
+	return getFileSize(filename) > 0;
+}
+
@@ -0,0 +1,208 @@
+#include "history.h"
+#include "report.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+static const char* historyHeader = "time,adapter,driver,backend,test,average_ms,corrected_ms,ratio";
+
+std::string historyTimeNow()
+{
+	time_t now = time(nullptr);
+	tm utc;
+	gmtime_s(&utc, &now);
+	char text[32];
+	strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", &utc);
+	return text;
+}
+
+bool appendHistory(const std::string& filename, const std::vector<HistoryEntry>& entries)
+{
+	bool exists = (bool)std::ifstream(filename);
+	FILE* file = nullptr;
+	fopen_s(&file, filename.c_str(), "a");
+	if (!file)
+		return false;
+
+	if (!exists)
+		fprintf(file, "%s\n", historyHeader);
+	for (const HistoryEntry& entry : entries)
+	{
+		fprintf(file, "%s,%s,%s,%s,%s,%.4f,%.4f,%.4f\n", entry.time.c_str(), csvQuote(entry.adapter).c_str(), csvQuote(entry.driver).c_str(),
+			csvQuote(entry.backend).c_str(), csvQuote(entry.test).c_str(), entry.averageMillis, entry.correctedMillis, entry.ratio);
+	}
+	fclose(file);
+	return true;
+}
+
+std::optional<std::vector<HistoryEntry>> loadHistory(const std::string& filename)
+{
+	std::ifstream file(filename);
+	std::string line;
+	if (!file || !std::getline(file, line))
+	{
+		printf("Can't read history %s\n", filename.c_str());
+		return {};
+	}
+
+	// Header lines of concatenated files are skipped
+	std::vector<HistoryEntry> entries;
+	unsigned lineNumber = 1;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if (line.empty() || line.rfind("time,", 0) == 0)
+			continue;
+		std::vector<std::string> fields = csvSplit(line);
+		if (fields.size() != 8)
+		{
+			printf("History %s:%u: expected 8 fields\n", filename.c_str(), lineNumber);
+			return {};
+		}
+		entries.push_back({
+			.time = fields[0],
+			.adapter = fields[1],
+			.driver = fields[2],
+			.backend = fields[3],
+			.test = fields[4],
+			.averageMillis = strtof(fields[5].c_str(), nullptr),
+			.correctedMillis = strtof(fields[6].c_str(), nullptr),
+			.ratio = strtof(fields[7].c_str(), nullptr) });
+	}
+	return entries;
+}
+
+static void splitSegment(const std::vector<double>& prefix, const std::vector<double>& prefixSquares, size_t begin, size_t end,
+	float minShift, float tThreshold, size_t minSegment, std::vector<ChangePoint>& changes)
+{
+	if (end - begin < 2 * minSegment)
+		return;
+
+	// Sum of squared deviations of [a, b) from prefix sums
+	auto sse = [&](size_t a, size_t b)
+	{
+		double sum = prefix[b] - prefix[a];
+		return std::max(prefixSquares[b] - prefixSquares[a] - sum * sum / (double)(b - a), 0.0);
+	};
+	auto mean = [&](size_t a, size_t b) { return (prefix[b] - prefix[a]) / (double)(b - a); };
+
+	size_t split = 0;
+	double bestError = 0.0;
+	for (size_t k = begin + minSegment; k + minSegment <= end; k++)
+	{
+		double error = sse(begin, k) + sse(k, end);
+		if (split == 0 || error < bestError)
+		{
+			split = k;
+			bestError = error;
+		}
+	}
+
+	double before = mean(begin, split);
+	double after = mean(split, end);
+	double left = (double)(split - begin);
+	double right = (double)(end - split);
+	double varianceBefore = sse(begin, split) / std::max(left - 1.0, 1.0);
+	double varianceAfter = sse(split, end) / std::max(right - 1.0, 1.0);
+	double standardError = std::sqrt(varianceBefore / left + varianceAfter / right);
+	double shift = std::fabs(after - before);
+	bool significant = standardError > 0.0 ? shift / standardError >= tThreshold : shift > 0.0;
+	if (!significant || shift < minShift * std::fabs(before))
+		return;
+
+	splitSegment(prefix, prefixSquares, begin, split, minShift, tThreshold, minSegment, changes);
+	changes.push_back({ split, (float)before, (float)after });
+	splitSegment(prefix, prefixSquares, split, end, minShift, tThreshold, minSegment, changes);
+}
+
+std::vector<ChangePoint> detectChangePoints(const std::vector<float>& series, float minShift, float tThreshold, size_t minSegment)
+{
+	std::vector<double> prefix(series.size() + 1, 0.0);
+	std::vector<double> prefixSquares(series.size() + 1, 0.0);
+	for (size_t i = 0; i < series.size(); i++)
+	{
+		prefix[i + 1] = prefix[i] + series[i];
+		prefixSquares[i + 1] = prefixSquares[i] + (double)series[i] * series[i];
+	}
+
+	std::vector<ChangePoint> changes;
+	splitSegment(prefix, prefixSquares, 0, series.size(), minShift, tThreshold, std::max(minSegment, (size_t)1), changes);
+	return changes;
+}
+
+float trendPerRun(const std::vector<float>& series)
+{
+	size_t n = series.size();
+	if (n < 2)
+		return 0.0f;
+
+	double meanX = (n - 1) * 0.5;
+	double meanY = 0.0;
+	for (float value : series)
+		meanY += value;
+	meanY /= n;
+
+	double covariance = 0.0;
+	double varianceX = 0.0;
+	for (size_t i = 0; i < n; i++)
+	{
+		covariance += (i - meanX) * (series[i] - meanY);
+		varianceX += (i - meanX) * (i - meanX);
+	}
+	return meanY != 0.0 ? (float)(covariance / varianceX / meanY) : 0.0f;
+}
+
+void printHistory(const std::vector<HistoryEntry>& entries, const std::string& filter)
+{
+	// Series in time order. The sort is stable, runs with the same time keep their file order.
+	std::vector<const HistoryEntry*> sorted;
+	for (const HistoryEntry& entry : entries)
+	{
+		if (filter.empty() || entry.adapter.find(filter) != std::string::npos || entry.test.find(filter) != std::string::npos)
+			sorted.push_back(&entry);
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const HistoryEntry* a, const HistoryEntry* b) { return a->time < b->time; });
+
+	std::map<std::tuple<std::string, std::string, std::string>, std::vector<const HistoryEntry*>> series;
+	for (const HistoryEntry* entry : sorted)
+		series[{ entry->adapter, entry->backend, entry->test }].push_back(entry);
+
+	unsigned stableSeries = 0;
+	for (auto&& [key, runs] : series)
+	{
+		std::vector<float> values;
+		for (const HistoryEntry* run : runs)
+			values.push_back(run->averageMillis);
+		std::vector<ChangePoint> changes = detectChangePoints(values);
+		if (changes.empty() && filter.empty())
+		{
+			stableSeries++;
+			continue;
+		}
+
+		auto& [adapter, backend, test] = key;
+		printf("\n%s | %s | %s: %u runs, latest %.3fms, trend %+.2f%%/run\n", adapter.c_str(), backend.c_str(), test.c_str(),
+			(unsigned)runs.size(), values.back(), trendPerRun(values) * 100.0f);
+		for (const ChangePoint& change : changes)
+		{
+			const HistoryEntry* previous = runs[change.index - 1];
+			const HistoryEntry* next = runs[change.index];
+			printf("  change at %s", next->time.c_str());
+			if (previous->driver != next->driver)
+				printf(" (driver %s -> %s)", previous->driver.c_str(), next->driver.c_str());
+			printf(": %.3fms -> %.3fms (%+.1f%%)\n", change.before, change.after, (change.after - change.before) / change.before * 100.0f);
+		}
+		if (!filter.empty())
+		{
+			for (const HistoryEntry* run : runs)
+				printf("  %s %s: %.3fms\n", run->time.c_str(), run->driver.c_str(), run->averageMillis);
+		}
+	}
+
+	if (filter.empty())
+		printf("\n%u of %u series without change points\n", stableSeries, (unsigned)series.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <vector>
+
+// Append-only results history: a CSV line per test case of every run. Runs of many machines can be
+// concatenated into one file. A series is the runs of one test on one adapter and backend, in time order,
+// across driver versions.
+struct HistoryEntry
+{
+	std::string time;			// UTC, ISO 8601, sorts in time order
+	std::string adapter;
+	std::string driver;			// User mode driver version
+	std::string backend;
+	std::string test;
+	float averageMillis;
+	float correctedMillis;
+	float ratio;
+};
+
+// UTC time of now in the HistoryEntry format
+std::string historyTimeNow();
+
+// Creates the file with a header line if it doesn't exist
+bool appendHistory(const std::string& filename, const std::vector<HistoryEntry>& entries);
+std::optional<std::vector<HistoryEntry>> loadHistory(const std::string& filename);
+
+// A level shift in a series. Values are the segment means around the change.
+struct ChangePoint
+{
+	size_t index;				// First run after the change
+	float before;
+	float after;
+};
+
+// Binary segmentation: splits a series where the split reduces the squared error the most, as long as
+// the mean shift is at least minShift (relative) and significant (Welch t above tThreshold), then
+// recurses into both segments. Segments have at least minSegment runs.
+std::vector<ChangePoint> detectChangePoints(const std::vector<float>& series, float minShift = 0.01f, float tThreshold = 5.0f, size_t minSegment = 3);
+
+// Least squares slope of the series relative to its mean, per run
+float trendPerRun(const std::vector<float>& series);
+
+// Prints every series that has change points. With a filter, every series whose adapter or test
+// contains it, with all of its runs.
+void printHistory(const std::vector<HistoryEntry>& entries, const std::string& filter);
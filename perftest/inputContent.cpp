@@ -0,0 +1,173 @@
+#include "inputContent.h"
+#include "directx.h"
+#include "file.h"
+#include <assert.h>
+#include <cstdio>
+#include <cstring>
+
+std::optional<InputContentDesc> parseInputContent(const std::string& arg)
+{
+	if (arg == "zero")
+		return InputContentDesc{ .content = InputContent::Zero };
+	if (arg == "constant")
+		return InputContentDesc{ .content = InputContent::Constant };
+	if (arg == "random")
+		return InputContentDesc{ .content = InputContent::Random };
+	if (arg == "gradient")
+		return InputContentDesc{ .content = InputContent::Gradient };
+	if (arg == "pattern")
+		return InputContentDesc{ .content = InputContent::Pattern };
+	if (arg.rfind("file:", 0) == 0 && arg.size() > 5)
+	{
+		// Missing and empty files would silently fill the inputs with zeros
+		std::string filename = arg.substr(5);
+		if (getFileSize(filename) <= 0)
+		{
+			printf("Input content file %s is missing or empty\n", filename.c_str());
+			return std::nullopt;
+		}
+		return InputContentDesc{ .content = InputContent::File, .filename = filename };
+	}
+	return std::nullopt;
+}
+
+std::string getInputContentName(const InputContentDesc& desc)
+{
+	switch (desc.content)
+	{
+	case InputContent::Undefined: return "undefined";
+	case InputContent::Zero: return "zero";
+	case InputContent::Constant: return "constant";
+	case InputContent::Random: return "random";
+	case InputContent::Gradient: return "gradient";
+	case InputContent::Pattern: return "pattern";
+	case InputContent::File: return "file " + desc.filename;
+	}
+	return "";
+}
+
+static uint16_t floatToHalf(float value)
+{
+	// Only for the [0, 1] range of the gradients. Values below the half normal range flush to zero.
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+	if (exponent <= 0)
+		return 0;
+	return (uint16_t)((exponent << 10) | ((bits >> 13) & 0x3ff));
+}
+
+static void encodeTexel(DXGI_FORMAT format, const float channels[4], unsigned char* ptr)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		for (unsigned c = 0; c < getFormatBytes(format); c++)
+			ptr[c] = (unsigned char)(channels[c] * 255.0f + 0.5f);
+		break;
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		for (unsigned c = 0; c < getFormatBytes(format) / 2; c++)
+		{
+			uint16_t half = floatToHalf(channels[c]);
+			memcpy(ptr + c * 2, &half, 2);
+		}
+		break;
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		memcpy(ptr, channels, getFormatBytes(format));
+		break;
+	default:
+		assert(false);
+	}
+}
+
+std::vector<unsigned char> generateBufferContent(const InputContentDesc& desc, unsigned bytes)
+{
+	std::vector<unsigned char> data(bytes);
+	switch (desc.content)
+	{
+	case InputContent::Undefined:
+	case InputContent::Zero:
+		break;
+
+	case InputContent::Constant:
+		// 0x3C3C3C3C is finite as a float and as a half float, and every 8 bit channel is equal
+		memset(data.data(), 0x3C, bytes);
+		break;
+
+	case InputContent::Random:
+	{
+		// Fixed seed, so every run reads the same data. Clearing bit 14 of both 16 bit halves
+		// keeps the exponents below all ones: every word is finite as a float and as two half floats.
+		uint32_t state = 0x12345678;
+		for (unsigned offset = 0; offset < bytes; offset += 4)
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			uint32_t word = state & ~0x40004000u;
+			memcpy(&data[offset], &word, min(bytes - offset, 4u));
+		}
+		break;
+	}
+
+	case InputContent::Gradient:
+	{
+		// Both halves ramp from 0 to 1 over the buffer
+		unsigned numWords = max(bytes / 4, 1u);
+		for (unsigned offset = 0; offset < bytes; offset += 4)
+		{
+			uint32_t half = floatToHalf((float)(offset / 4) / numWords);
+			uint32_t word = (half << 16) | half;
+			memcpy(&data[offset], &word, min(bytes - offset, 4u));
+		}
+		break;
+	}
+
+	case InputContent::Pattern:
+		// Both halves in the [1, 2) half float range. As a 32 bit float the word is around 2^-7.
+		for (unsigned offset = 0; offset < bytes; offset += 4)
+		{
+			uint32_t hash = (offset / 4 + 1) * 0x3504f333;
+			uint32_t word = ((0x3C00 | ((hash >> 16) & 0x3ff)) << 16) | (0x3C00 | (hash & 0x3ff));
+			memcpy(&data[offset], &word, min(bytes - offset, 4u));
+		}
+		break;
+
+	case InputContent::File:
+	{
+		std::vector<unsigned char> file = loadFile(desc.filename);
+		assert(!file.empty());
+		for (unsigned offset = 0; offset < bytes && !file.empty(); offset++)
+			data[offset] = file[offset % file.size()];
+		break;
+	}
+	}
+	return data;
+}
+
+std::vector<unsigned char> generateTextureContent(const InputContentDesc& desc, uint2 dimensions, DXGI_FORMAT format)
+{
+	unsigned formatBytes = getFormatBytes(format);
+	if (desc.content != InputContent::Gradient)
+		return generateBufferContent(desc, dimensions.x * dimensions.y * formatBytes);
+
+	// Red ramps horizontally, green vertically, blue diagonally
+	std::vector<unsigned char> data(dimensions.x * dimensions.y * formatBytes);
+	for (unsigned y = 0; y < dimensions.y; y++)
+	{
+		for (unsigned x = 0; x < dimensions.x; x++)
+		{
+			float u = (float)x / max(dimensions.x - 1, 1u);
+			float v = (float)y / max(dimensions.y - 1, 1u);
+			float channels[4] = { u, v, (u + v) * 0.5f, 1.0f };
+			encodeTexel(format, channels, &data[(y * dimensions.x + x) * formatBytes]);
+		}
+	}
+	return data;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "datatypes.h"
+#include <dxgiformat.h>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Contents of the benchmark input resources. Compressed memory paths (DCC, delta color compression)
+// and zero page tricks make reads of cleared or uniform memory faster than reads of real data.
+enum class InputContent
+{
+	Undefined,		// Never written. Usually reads as zero.
+	Zero,
+	Constant,		// Same value in every byte
+	Random,
+	Gradient,
+	Pattern,		// Validation pattern. Finite through every view format.
+	File			// Raw bytes of a file, repeated to fill the resource
+};
+
+struct InputContentDesc
+{
+	InputContent content = InputContent::Undefined;
+	std::string filename;		// InputContent::File
+};
+
+// "zero", "constant", "random", "gradient", "pattern" or "file:PATH"
+std::optional<InputContentDesc> parseInputContent(const std::string& arg);
+std::string getInputContentName(const InputContentDesc& desc);
+
+// Buffers are viewed through several formats, their content is generated per 32 bit word.
+// Textures have a single format, gradients are encoded per texel.
+std::vector<unsigned char> generateBufferContent(const InputContentDesc& desc, unsigned bytes);
+std::vector<unsigned char> generateTextureContent(const InputContentDesc& desc, uint2 dimensions, DXGI_FORMAT format);
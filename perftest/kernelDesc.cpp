@@ -0,0 +1,180 @@
+#include "kernelDesc.h"
+#include "loadConstantsGPU.h"
+#include <cstring>
+
+std::optional<KernelDesc> parseKernelName(const std::string& filename)
+{
+	// Strip directory and extension
+	size_t nameStart = filename.find_last_of("/\\");
+	nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+	size_t nameEnd = filename.find_last_of('.');
+	if (nameEnd == std::string::npos || nameEnd < nameStart)
+		nameEnd = filename.length();
+	std::string name = filename.substr(nameStart, nameEnd - nameStart);
+
+	struct Prefix
+	{
+		const char* prefix;
+		KernelResource resource;
+	};
+
+	const Prefix prefixes[] =
+	{
+		{ "loadTyped", KernelResource::Typed },
+		{ "loadRaw", KernelResource::Raw },
+		{ "loadStructured", KernelResource::Structured },
+		{ "loadConstant", KernelResource::Constant },
+		{ "loadTex", KernelResource::Texture },
+		{ "sampleTex", KernelResource::SampledTexture },
+		{ "loadStructAosRaw", KernelResource::StructAosRaw },
+		{ "loadStructAos", KernelResource::StructAos },
+		{ "loadStructSoa", KernelResource::StructSoa },
+	};
+
+	KernelDesc desc = {
+		.binding = KernelBinding::Direct,
+		.element = KernelElement::Float32,
+		.loadsPerThread = 256,
+		.structBytes = 0,
+		.fieldsRead = 0,
+		.aluChain = false,
+		.occupancyLdsBytes = 0,
+		.waveTiming = false };
+	size_t pos = std::string::npos;
+	for (const Prefix& prefix : prefixes)
+	{
+		if (name.rfind(prefix.prefix, 0) == 0)
+		{
+			desc.resource = prefix.resource;
+			pos = strlen(prefix.prefix);
+			break;
+		}
+	}
+	if (pos == std::string::npos)
+		return {};
+
+	// Struct layout kernels: "64b2f" (AoS struct bytes and fields read) or "2f" (SoA fields read)
+	bool structLayout = desc.resource == KernelResource::StructAos || desc.resource == KernelResource::StructAosRaw || desc.resource == KernelResource::StructSoa;
+	if (structLayout)
+	{
+		auto parseNumber = [&](char suffix)
+		{
+			size_t end = name.find(suffix, pos);
+			if (end == std::string::npos || end == pos || name.find_first_not_of("0123456789", pos) != end)
+				return 0u;
+			unsigned number = (unsigned)std::stoul(name.substr(pos, end - pos));
+			pos = end + 1;
+			return number;
+		};
+
+		if (desc.resource != KernelResource::StructSoa)
+			desc.structBytes = parseNumber('b');
+		desc.fieldsRead = parseNumber('f');
+		if (desc.resource == KernelResource::StructSoa)
+			desc.structBytes = desc.fieldsRead * 16;
+		if (desc.fieldsRead == 0 || desc.structBytes < desc.fieldsRead * 16)
+			return {};
+
+		desc.loadWidth = 4;
+		desc.loadsPerThread = STRUCTS_PER_THREAD * desc.fieldsRead;
+	}
+	else
+	{
+		// Load width: "1d", "2d", "3d" or "4d"
+		if (pos + 1 >= name.length() || name[pos] < '1' || name[pos] > '4' || name[pos + 1] != 'd')
+			return {};
+		desc.loadWidth = name[pos] - '0';
+		pos += 2;
+	}
+
+	// Optional native element type
+	if (name.compare(pos, 3, "F16") == 0)
+		desc.element = KernelElement::Float16;
+	else if (name.compare(pos, 3, "U16") == 0)
+		desc.element = KernelElement::Uint16;
+	else if (name.compare(pos, 3, "U64") == 0)
+		desc.element = KernelElement::Uint64;
+	if (desc.element != KernelElement::Float32)
+		pos += 3;
+
+	// Pattern, optionally followed by the latency hiding permutation or the binding
+	std::string pattern = name.substr(pos);
+	size_t bindingStart = pattern.find_first_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ", 1);
+	std::string binding = bindingStart == std::string::npos ? "" : pattern.substr(bindingStart);
+	pattern = pattern.substr(0, bindingStart);
+
+	if (pattern == "Invariant")
+		desc.pattern = KernelPattern::Invariant;
+	else if (pattern == "Linear")
+		desc.pattern = KernelPattern::Linear;
+	else if (pattern == "Random")
+		desc.pattern = KernelPattern::Random;
+	else if (pattern == "Strided")
+		desc.pattern = KernelPattern::Strided;
+	else if (pattern == "Morton")
+		desc.pattern = KernelPattern::Morton;
+	else if (pattern == "Divergent")
+		desc.pattern = KernelPattern::Divergent;
+	else if (pattern == "Clustered")
+		desc.pattern = KernelPattern::Clustered;
+	else if (pattern == "Indexed")
+		desc.pattern = KernelPattern::Indexed;
+	else if (pattern == "Paged")
+		desc.pattern = KernelPattern::Paged;
+	else if (pattern == "Trace")
+		desc.pattern = KernelPattern::Trace;
+	else
+		return {};
+
+	// Latency hiding: "Alu", optionally followed by "Lds<KB>k"
+	if (binding.rfind("Alu", 0) == 0)
+	{
+		desc.aluChain = true;
+		binding = binding.substr(3);
+	}
+	if (binding.rfind("Lds", 0) == 0)
+	{
+		size_t end = binding.find_first_not_of("0123456789", 3);
+		if (end == 3 || end == std::string::npos || binding[end] != 'k')
+			return {};
+		desc.occupancyLdsBytes = (unsigned)std::stoul(binding.substr(3, end - 3)) * 1024;
+		binding = binding.substr(end + 1);
+	}
+
+	if (binding == "Timed")
+	{
+		desc.waveTiming = true;
+		binding = "";
+	}
+
+	if (binding == "")
+		desc.binding = KernelBinding::Direct;
+	else if (binding == "Bindless")
+		desc.binding = KernelBinding::Bindless;
+	else if (binding == "BindlessWave")
+		desc.binding = KernelBinding::BindlessWave;
+	else if (binding == "BindlessNonUniform")
+		desc.binding = KernelBinding::BindlessNonUniform;
+	else if (binding == "RootDescriptor")
+		desc.binding = KernelBinding::RootDescriptor;
+	else if (binding == "RootConstants")
+		desc.binding = KernelBinding::RootConstants;
+	else
+		return {};
+
+	return desc;
+}
+
+unsigned getElementBytes(KernelElement element)
+{
+	switch (element)
+	{
+	case KernelElement::Float16:
+	case KernelElement::Uint16:
+		return 2;
+	case KernelElement::Uint64:
+		return 8;
+	default:
+		return 4;
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+// Benchmark kernel permutation, parsed from the shader file name. For example "shaders/loadRaw4dRandom.cso",
+// "shaders/loadRaw4dF16Random.cso", "shaders/loadRaw4dRandomBindlessWave.cso", "shaders/loadStructAos64b2fLinear.cso"
+// or "shaders/loadRaw4dLinearAluLds8k.cso".
+enum class KernelResource
+{
+	Typed,
+	Raw,
+	Structured,
+	Constant,
+	Texture,
+	SampledTexture,
+	StructAos,			// Struct layout kernels: StructuredBuffer of structs
+	StructAosRaw,		// ByteAddressBuffer with the same struct layout
+	StructSoa			// One float4 array per field
+};
+
+// Start element of each thread (accessPattern.hlsli)
+enum class KernelPattern
+{
+	Invariant,
+	Linear,
+	Random,
+	Strided,		// Constant stride between neighbour threads
+	Morton,			// 2d tile in Morton order
+	Divergent,		// PATTERN_WAYS addresses per wave
+	Clustered,		// Linear clusters at random starts
+	Indexed,		// Start element read from an index buffer
+	Paged,			// Threads spread over a large buffer, a page per lane
+	Trace			// Every element read from a captured address trace (loadTraceBody.hlsli)
+};
+
+// Type of the loaded channels. Float32 kernels load 32-bit words, the others use native types (SM 6.2)
+// and accumulate in them.
+enum class KernelElement
+{
+	Float32,
+	Float16,
+	Uint16,
+	Uint64
+};
+
+// How the kernel binds its constants and source
+enum class KernelBinding
+{
+	Direct,				// Descriptor table
+	Bindless,			// Descriptor heap, dispatch uniform index
+	BindlessWave,		// Descriptor heap, wave uniform index
+	BindlessNonUniform,	// Descriptor heap, per lane index
+	RootDescriptor,		// Root CBV and SRV
+	RootConstants		// Root constants, SRV in a descriptor table
+};
+
+struct KernelDesc
+{
+	KernelResource resource;
+	KernelPattern pattern;
+	KernelBinding binding;
+	KernelElement element;
+	unsigned loadWidth;			// Channels per load (LOAD_WIDTH)
+	unsigned loadsPerThread;	// Inner loop iterations
+	unsigned structBytes;		// Struct layout kernels: struct size (SoA: fields * 16)
+	unsigned fieldsRead;		// Struct layout kernels: float4 fields read per struct
+	bool aluChain;				// Latency hiding kernels: dependent ALU ops per load ("Alu")
+	unsigned occupancyLdsBytes;	// Latency hiding kernels: extra groupshared memory ("Lds8k")
+	bool waveTiming;			// Instrumented kernels: per wave start and end ticks ("Timed")
+};
+
+std::optional<KernelDesc> parseKernelName(const std::string& filename);
+unsigned getElementBytes(KernelElement element);
@@ -0,0 +1,25 @@
+// Latency hiding permutations of the typed, raw, structured and texture load kernels. Define:
+// ALU_CHAIN: loadConstants.aluOps dependent ALU ops on every loaded value before it is accumulated
+// OCCUPANCY_LDS_BYTES: extra groupshared memory per group. Fewer groups (waves per SIMD) fit on a CU.
+// Include after the loadConstants cbuffer.
+
+#ifndef OCCUPANCY_LDS_BYTES
+#define OCCUPANCY_LDS_BYTES 0
+#endif
+
+// Appended to dummyLDS. The output read index is a runtime constant, so the compiler can't trim the array.
+#define OCCUPANCY_LDS_FLOATS (OCCUPANCY_LDS_BYTES / 4)
+
+#if defined(ALU_CHAIN)
+float4 aluChain(float4 loaded)
+{
+	// aluScale and aluBias are always 1 and 0, mad(x, 1, 0) is exact. But the compiler doesn't know this.
+	[loop]
+	for (uint i = 0; i < loadConstants.aluOps; ++i)
+		loaded = mad(loaded, loadConstants.aluScale, loadConstants.aluBias);
+	return loaded;
+}
+#else
+// Any type. Native 16/64-bit kernels have no ALU chain permutations.
+#define aluChain(loaded) (loaded)
+#endif
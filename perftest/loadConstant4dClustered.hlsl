@@ -0,0 +1,2 @@
+#define LOAD_CLUSTERED
+#include "loadConstantBody.hlsli"
@@ -0,0 +1,2 @@
+#define LOAD_DIVERGENT
+#include "loadConstantBody.hlsli"
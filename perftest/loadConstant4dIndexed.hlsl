@@ -0,0 +1,2 @@
+#define LOAD_INDEXED
+#include "loadConstantBody.hlsli"
@@ -0,0 +1,2 @@
+#define LOAD_MORTON
+#include "loadConstantBody.hlsli"
@@ -0,0 +1,2 @@
+#define LOAD_STRIDED
+#include "loadConstantBody.hlsli"
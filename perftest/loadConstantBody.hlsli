@@ -1,4 +1,3 @@
-#include "hash.hlsli"
 #include "loadConstantsGPU.h"
 
 RWBuffer<float> output : register(u0);
@@ -8,9 +7,12 @@ cbuffer CB0 : register(b0)
 	LoadConstantsWithArray loadConstants;
 };
 
+#include "accessPattern.hlsli"
+
 #define ROOT_SIGNATURE \
 	"DescriptorTable(" \
 		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		PATTERN_SRVS \
 		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
 
 #define THREAD_GROUP_SIZE 256
@@ -23,16 +25,7 @@ void main(uint3 tid : SV_DispatchThreadID, uint gix : SV_GroupIndex)
 {
 	float4 value = 0.0;
 	
-#if defined(LOAD_INVARIANT)
-    // All threads load from same address. Index is wave invariant.
-	uint htid = 0;
-#elif defined(LOAD_LINEAR)
-	// Linearly increasing starting address to allow memory coalescing
-	uint htid = gix;
-#elif defined(LOAD_RANDOM)
-    // Randomize start address offset (0-15) to prevent memory coalescing
-	uint htid = (hash1(gix) & 0xf);
-#endif
+	uint htid = patternStart(gix);
 
 	[loop]
 	for (int i = 0; i < 256; ++i)
@@ -3,11 +3,45 @@
 #include "dataTypes.h"
 #endif
 
+// Bindless kernels: consecutive descriptors viewing the same source, indexed per wave or per lane
+#define BINDLESS_DESCRIPTOR_COPIES 8
+
+// Struct layout kernels: structs in the source buffer, and structs read per thread
+#define STRUCT_COUNT 256
+#define STRUCTS_PER_THREAD 64
+
+// Access pattern parameters (accessPattern.hlsli)
+#define PATTERN_STRIDE 4		// Strided: elements between neighbour threads
+#define PATTERN_WAYS 4			// Divergent: default distinct addresses per wave (LoadConstants.patternWays)
+#define MAX_PATTERN_WAYS 64		// Divergent: addresses stay inside the buffers and the 16x16 texel block
+#define PATTERN_CLUSTER 8		// Clustered: threads per linear cluster
+#define GATHER_INDEX_COUNT 256	// Indexed: start element indices, one per thread of a group
+
+// Address trace replay (loadTraceBody.hlsli)
+#define TRACE_MAX_THREADS 256		// Traced threads replayed by a thread group
+#define TRACE_MAX_ELEMENTS (1 << 22)	// Float4 element indices must be below this. The sources fit the largest index.
+#define TRACE_TEXTURE_WIDTH 256		// Texture sources: element index to texel (index % width, index / width)
+
+// Latency hiding kernels (latencyHiding.hlsli): ALU ops per load are swept 0, 1, 4 ... MAX_ALU_OPS
+#define MAX_ALU_OPS 64
+
+// Wave timing kernels (waveTiming.hlsli): counters, then 16 byte records. Waves of 4+ lanes of a 1024x1024 dispatch.
+#define WAVE_TIMING_HEADER_BYTES 16
+#define MAX_TIMED_WAVES (1024 * 1024 / 4)
+
 struct LoadConstants
 {
 	uint elementsMask;		// Runtime address mask. Needed to prevent compiler combining narrow raw buffer loads from single thread.
 	uint writeIndex;		// Runtime write mask. Always 0xffffffff (= never write). But the compiler doesn't know this :)
 	uint readStartAddress;
+	uint descriptorIndex;	// Bindless kernels: heap index of the first source descriptor
+	uint patternWays;		// Divergent pattern: distinct addresses per wave, 1-MAX_PATTERN_WAYS
+	uint traceThreads;		// Trace kernels: traced threads and loads per thread
+	uint traceLoads;
+	uint aluOps;			// Latency hiding kernels: dependent mad(x, aluScale, aluBias) ops per load, 0-MAX_ALU_OPS
+	float aluScale;			// Always 1.0 and 0.0. But the compiler doesn't know this :)
+	float aluBias;
+	uint pageStride;		// Paged pattern: float4 elements between neighbour threads
 	uint padding;
 };
 
@@ -16,6 +50,14 @@ struct LoadConstantsWithArray
 	uint elementsMask;		// Runtime address mask. Needed to prevent compiler combining narrow raw buffer loads from single thread.
 	uint writeIndex;		// Runtime write mask. Always 0xffffffff (= never write). But the compiler doesn't know this :)
 	uint readStartAddress;
+	uint descriptorIndex;	// Bindless kernels: heap index of the first source descriptor
+	uint patternWays;		// Divergent pattern: distinct addresses per wave, 1-MAX_PATTERN_WAYS
+	uint traceThreads;		// Trace kernels: traced threads and loads per thread
+	uint traceLoads;
+	uint aluOps;			// Latency hiding kernels: dependent mad(x, aluScale, aluBias) ops per load, 0-MAX_ALU_OPS
+	float aluScale;			// Always 1.0 and 0.0. But the compiler doesn't know this :)
+	float aluBias;
+	uint pageStride;		// Paged pattern: float4 elements between neighbour threads
 	uint padding;
 
 	float4 benchmarkArray[1024];	// 16 KB test array (fits inside L1$)
@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 1
+#define LOAD_INVARIANT
+#define ELEMENT_TYPE float16_t
+#define ELEMENT_BYTES 2
+#include "loadRawBody.hlsli"
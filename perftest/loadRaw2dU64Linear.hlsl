@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 2
+#define LOAD_LINEAR
+#define ELEMENT_TYPE uint64_t
+#define ELEMENT_BYTES 8
+#include "loadRawBody.hlsli"
@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_INVARIANT
+#define ROOT_DESCRIPTORS
+#include "rootBinding.hlsli"
+#include "loadRawBody.hlsli"
@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_LINEAR
+#define ALU_CHAIN
+#define OCCUPANCY_LDS_BYTES 8192
+#include "loadRawBody.hlsli"
@@ -0,0 +1,3 @@
+#define LOAD_WIDTH 4
+#define LOAD_PAGED
+#include "loadRawBody.hlsli"
@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_RANDOM
+#define ROOT_CONSTANTS
+#include "rootBinding.hlsli"
+#include "loadRawBody.hlsli"
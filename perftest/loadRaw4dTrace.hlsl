@@ -0,0 +1,4 @@
+#define LOAD_WIDTH 4
+#define TRACE_RAW
+ByteAddressBuffer sourceData : register(t0);
+#include "loadTraceBody.hlsli"
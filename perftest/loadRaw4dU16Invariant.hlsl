@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_INVARIANT
+#define ELEMENT_TYPE uint16_t
+#define ELEMENT_BYTES 2
+#include "loadRawBody.hlsli"
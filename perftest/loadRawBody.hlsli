@@ -1,43 +1,58 @@
-#include "hash.hlsli"
 #include "loadConstantsGPU.h"
 
 RWBuffer<float> output : register(u0);
+#ifndef BINDLESS
 ByteAddressBuffer sourceData : register(t0);
+#endif
 
 cbuffer CB0 : register(b0)
 {
 	LoadConstants loadConstants;
 };
 
+#include "accessPattern.hlsli"
+#include "latencyHiding.hlsli"
+#include "waveTiming.hlsli"
+
+#ifndef ROOT_SIGNATURE
 #define ROOT_SIGNATURE \
 	"DescriptorTable(" \
 		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
 		"SRV(t0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		PATTERN_SRVS \
+		WAVE_TIMING_UAVS \
 		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
+#endif
+
+// Native 16/64-bit kernels define ELEMENT_TYPE, and accumulate in it
+#ifndef ELEMENT_BYTES
+#define ELEMENT_BYTES 4
+#endif
 
 #define THREAD_GROUP_SIZE 256
 
-groupshared float dummyLDS[THREAD_GROUP_SIZE];
+groupshared float dummyLDS[THREAD_GROUP_SIZE + OCCUPANCY_LDS_FLOATS];
 
 [RootSignature(ROOT_SIGNATURE)]
 [numthreads(THREAD_GROUP_SIZE, 1, 1)]
 void main(uint3 tid : SV_DispatchThreadID, uint gix : SV_GroupIndex)
 {
+#ifdef ELEMENT_TYPE
+	vector<ELEMENT_TYPE, 4> value = 0;
+#else
 	float4 value = 0.0;
-	
-#if defined(LOAD_INVARIANT)
-    // All threads load from same address. Index is wave invariant.
-	uint htid = 0;
-#elif defined(LOAD_LINEAR)
-	// Linearly increasing starting address to allow memory coalescing
-	uint htid = gix;
-#elif defined(LOAD_RANDOM)
-    // Randomize start address offset (0-15) to prevent memory coalescing
-	uint htid = hash1(gix) & 0xf;
 #endif
+#ifdef BINDLESS
+	SOURCE_TYPE sourceData = ResourceDescriptorHeap[BINDLESS_INDEX(gix)];
+#endif
+	
+	uint2 waveBegin = waveTimingBegin();
+	uint htid = patternStart(gix);
 
 	// Moved out all math from the inner loop
-#if LOAD_WIDTH == 1
+#if defined(ELEMENT_TYPE)
+	htid = htid * (ELEMENT_BYTES * LOAD_WIDTH) + loadConstants.readStartAddress;
+#elif LOAD_WIDTH == 1
 	htid = htid * 4 + loadConstants.readStartAddress;
 #elif LOAD_WIDTH == 2
 	htid = htid * 8 + loadConstants.readStartAddress;
@@ -51,21 +66,29 @@ void main(uint3 tid : SV_DispatchThreadID, uint gix : SV_GroupIndex)
 	for (int i = 0; i < 256; ++i)
 	{
 		// Mask with runtime constant to prevent unwanted compiler optimizations
-		uint address = (htid + i * (4 * LOAD_WIDTH)) | loadConstants.elementsMask;	
+		uint address = (htid + i * (ELEMENT_BYTES * LOAD_WIDTH)) | loadConstants.elementsMask;	
 
-#if LOAD_WIDTH == 1
-		value += asfloat(sourceData.Load(address).xxxx);
+#if defined(ELEMENT_TYPE) && LOAD_WIDTH == 1
+		value += sourceData.Load<ELEMENT_TYPE>(address).xxxx;
+#elif defined(ELEMENT_TYPE) && LOAD_WIDTH == 2
+		value += sourceData.Load<vector<ELEMENT_TYPE, 2> >(address).xyxy;
+#elif defined(ELEMENT_TYPE) && LOAD_WIDTH == 4
+		value += sourceData.Load<vector<ELEMENT_TYPE, 4> >(address).xyzw;
+#elif LOAD_WIDTH == 1
+		value += aluChain(asfloat(sourceData.Load(address).xxxx));
 #elif LOAD_WIDTH == 2
-		value += asfloat(sourceData.Load2(address).xyxy);
+		value += aluChain(asfloat(sourceData.Load2(address).xyxy));
 #elif LOAD_WIDTH == 3
-		value += asfloat(sourceData.Load3(address).xyzx); 
+		value += aluChain(asfloat(sourceData.Load3(address).xyzx));
 #elif LOAD_WIDTH == 4
-		value += asfloat(sourceData.Load4(address).xyzw);
+		value += aluChain(asfloat(sourceData.Load4(address).xyzw));
 #endif
 	}
 
+	waveTimingEnd(waveBegin, tid, (float)value.x);
+
     // Linear write to LDS (no bank conflicts). Significantly faster than memory loads.
-	dummyLDS[gix] = value.x + value.y + value.z + value.w;
+	dummyLDS[gix] = (float)(value.x + value.y + value.z + value.w);
 
 	GroupMemoryBarrierWithGroupSync();
 
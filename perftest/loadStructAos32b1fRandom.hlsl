@@ -0,0 +1,5 @@
+#define STRUCT_FLOAT4S 2
+#define FIELDS_READ 1
+#define LAYOUT_AOS_STRUCTURED
+#define LOAD_RANDOM
+#include "loadStructBody.hlsli"
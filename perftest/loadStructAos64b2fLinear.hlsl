@@ -0,0 +1,5 @@
+#define STRUCT_FLOAT4S 4
+#define FIELDS_READ 2
+#define LAYOUT_AOS_STRUCTURED
+#define LOAD_LINEAR
+#include "loadStructBody.hlsli"
@@ -0,0 +1,5 @@
+#define STRUCT_FLOAT4S 8
+#define FIELDS_READ 8
+#define LAYOUT_AOS_RAW
+#define LOAD_RANDOM
+#include "loadStructBody.hlsli"
@@ -0,0 +1,5 @@
+#define STRUCT_FLOAT4S 16
+#define FIELDS_READ 1
+#define LAYOUT_AOS_RAW
+#define LOAD_LINEAR
+#include "loadStructBody.hlsli"
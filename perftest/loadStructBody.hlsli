@@ -0,0 +1,80 @@
+#include "loadConstantsGPU.h"
+
+// Struct layout kernels. Structs of STRUCT_FLOAT4S float4 fields (32-256 bytes), FIELDS_READ of them read
+// per struct. One of the layouts:
+// LAYOUT_AOS_STRUCTURED: array of structs, StructuredBuffer<Struct>
+// LAYOUT_AOS_RAW: array of structs, manual offsets into a ByteAddressBuffer
+// LAYOUT_SOA: struct of arrays, one float4 array per field stored as consecutive planes of STRUCT_COUNT elements
+RWBuffer<float> output : register(u0);
+
+#if defined(LAYOUT_AOS_STRUCTURED)
+struct Struct
+{
+	float4 fields[STRUCT_FLOAT4S];
+};
+StructuredBuffer<Struct> sourceData : register(t0);
+#elif defined(LAYOUT_AOS_RAW)
+ByteAddressBuffer sourceData : register(t0);
+#elif defined(LAYOUT_SOA)
+StructuredBuffer<float4> sourceData : register(t0);
+#endif
+
+cbuffer CB0 : register(b0)
+{
+	LoadConstants loadConstants;
+};
+
+#include "accessPattern.hlsli"
+
+#define ROOT_SIGNATURE \
+	"DescriptorTable(" \
+		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		"SRV(t0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		PATTERN_SRVS \
+		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
+
+#define THREAD_GROUP_SIZE 256
+
+groupshared float dummyLDS[THREAD_GROUP_SIZE];
+
+[RootSignature(ROOT_SIGNATURE)]
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void main(uint3 tid : SV_DispatchThreadID, uint gix : SV_GroupIndex)
+{
+	float4 value = 0.0;
+	
+	uint htid = patternStart(gix);
+
+	// Same structs for every layout, only the addressing differs
+	[loop]
+	for (int i = 0; i < STRUCTS_PER_THREAD; ++i)
+	{
+		// Mask with runtime constant to prevent unwanted compiler optimizations
+		uint structIdx = ((htid + i) & (STRUCT_COUNT - 1)) | loadConstants.elementsMask;
+
+		[unroll]
+		for (int field = 0; field < FIELDS_READ; ++field)
+		{
+#if defined(LAYOUT_AOS_STRUCTURED)
+			value += sourceData[structIdx].fields[field];
+#elif defined(LAYOUT_AOS_RAW)
+			value += asfloat(sourceData.Load4(structIdx * (STRUCT_FLOAT4S * 16) + field * 16));
+#elif defined(LAYOUT_SOA)
+			value += sourceData[field * STRUCT_COUNT + structIdx];
+#endif
+		}
+	}
+
+    // Linear write to LDS (no bank conflicts). Significantly faster than memory loads.
+	dummyLDS[gix] = value.x + value.y + value.z + value.w;
+
+	GroupMemoryBarrierWithGroupSync();
+
+	// This branch is never taken, but the compiler doesn't know it
+	// Optimizer would remove all the memory loads if the data wouldn't be potentially used
+	[branch]
+	if (loadConstants.writeIndex != 0xffffffff)
+	{
+        output[tid.x + tid.y] = dummyLDS[loadConstants.writeIndex];
+    }
+}
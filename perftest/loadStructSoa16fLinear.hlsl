@@ -0,0 +1,5 @@
+#define STRUCT_FLOAT4S 16
+#define FIELDS_READ 16
+#define LAYOUT_SOA
+#define LOAD_LINEAR
+#include "loadStructBody.hlsli"
@@ -0,0 +1,5 @@
+#define STRUCT_FLOAT4S 1
+#define FIELDS_READ 1
+#define LAYOUT_SOA
+#define LOAD_RANDOM
+#include "loadStructBody.hlsli"
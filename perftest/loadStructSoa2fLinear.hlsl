@@ -0,0 +1,5 @@
+#define STRUCT_FLOAT4S 2
+#define FIELDS_READ 2
+#define LAYOUT_SOA
+#define LOAD_LINEAR
+#include "loadStructBody.hlsli"
@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 1
+#define LOAD_LINEAR
+#define ELEMENT_TYPE float16_t
+#define ELEMENT_BYTES 2
+StructuredBuffer<float16_t> sourceData : register(t0);
+#include "loadStructuredBody.hlsli"
@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 2
+#define LOAD_INVARIANT
+#define ELEMENT_TYPE float16_t
+#define ELEMENT_BYTES 2
+StructuredBuffer<float16_t2> sourceData : register(t0);
+#include "loadStructuredBody.hlsli"
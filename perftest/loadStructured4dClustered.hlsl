@@ -0,0 +1,4 @@
+#define LOAD_WIDTH 4
+#define LOAD_CLUSTERED
+StructuredBuffer<float4> sourceData : register(t0);
+#include "loadStructuredBody.hlsli"
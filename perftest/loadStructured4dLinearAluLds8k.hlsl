@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 4
+#define LOAD_LINEAR
+#define ALU_CHAIN
+#define OCCUPANCY_LDS_BYTES 8192
+StructuredBuffer<float4> sourceData : register(t0);
+#include "loadStructuredBody.hlsli"
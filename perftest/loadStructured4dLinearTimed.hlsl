@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_LINEAR
+#define WAVE_TIMING
+StructuredBuffer<float4> sourceData : register(t0);
+#include "loadStructuredBody.hlsli"
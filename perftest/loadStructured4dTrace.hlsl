@@ -0,0 +1,4 @@
+#define LOAD_WIDTH 4
+#define TRACE_STRUCTURED
+StructuredBuffer<float4> sourceData : register(t0);
+#include "loadTraceBody.hlsli"
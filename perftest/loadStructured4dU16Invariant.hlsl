@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 4
+#define LOAD_INVARIANT
+#define ELEMENT_TYPE uint16_t
+#define ELEMENT_BYTES 2
+StructuredBuffer<uint16_t4> sourceData : register(t0);
+#include "loadStructuredBody.hlsli"
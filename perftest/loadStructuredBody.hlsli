@@ -1,4 +1,3 @@
-#include "hash.hlsli"
 #include "loadConstantsGPU.h"
 
 RWBuffer<float> output : register(u0);
@@ -8,32 +7,39 @@ cbuffer CB0 : register(b0)
 	LoadConstants loadConstants;
 };
 
+#include "accessPattern.hlsli"
+#include "latencyHiding.hlsli"
+#include "waveTiming.hlsli"
+
+#ifndef ROOT_SIGNATURE
 #define ROOT_SIGNATURE \
 	"DescriptorTable(" \
 		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
 		"SRV(t0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		PATTERN_SRVS \
+		WAVE_TIMING_UAVS \
 		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
+#endif
 
 #define THREAD_GROUP_SIZE 256
 
-groupshared float dummyLDS[THREAD_GROUP_SIZE];
+groupshared float dummyLDS[THREAD_GROUP_SIZE + OCCUPANCY_LDS_FLOATS];
 
 [RootSignature(ROOT_SIGNATURE)]
 [numthreads(THREAD_GROUP_SIZE, 1, 1)]
 void main(uint3 tid : SV_DispatchThreadID, uint gix : SV_GroupIndex)
 {
+#ifdef ELEMENT_TYPE
+	vector<ELEMENT_TYPE, 4> value = 0;		// Native 16-bit kernels accumulate in their element type
+#else
 	float4 value = 0.0;
-	
-#if defined(LOAD_INVARIANT)
-    // All threads load from same address. Index is wave invariant.
-	uint htid = 0;
-#elif defined(LOAD_LINEAR)
-	// Linearly increasing starting address to allow memory coalescing
-	uint htid = gix;
-#elif defined(LOAD_RANDOM)
-    // Randomize start address offset (0-15) to prevent memory coalescing
-	uint htid = (hash1(gix) & 0xf);
 #endif
+#ifdef BINDLESS
+	SOURCE_TYPE sourceData = ResourceDescriptorHeap[BINDLESS_INDEX(gix)];
+#endif
+	
+	uint2 waveBegin = waveTimingBegin();
+	uint htid = patternStart(gix);
 
 	[loop]
 	for (int i = 0; i < 256; ++i)
@@ -42,16 +48,18 @@ void main(uint3 tid : SV_DispatchThreadID, uint gix : SV_GroupIndex)
 		uint elemIdx = (htid + i) | loadConstants.elementsMask;
 
 #if LOAD_WIDTH == 1
-		value += sourceData[elemIdx].xxxx;
+		value += aluChain(sourceData[elemIdx].xxxx);
 #elif LOAD_WIDTH == 2
-		value += sourceData[elemIdx].xyxy;
+		value += aluChain(sourceData[elemIdx].xyxy);
 #elif LOAD_WIDTH == 4
-		value += sourceData[elemIdx].xyzw;
+		value += aluChain(sourceData[elemIdx].xyzw);
 #endif
 	}
 
+	waveTimingEnd(waveBegin, tid, value.x);
+
     // Linear write to LDS (no bank conflicts). Significantly faster than memory loads.
-	dummyLDS[gix] = value.x + value.y + value.z + value.w;
+	dummyLDS[gix] = (float)(value.x + value.y + value.z + value.w);
 
 	GroupMemoryBarrierWithGroupSync();
 
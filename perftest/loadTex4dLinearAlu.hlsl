@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_LINEAR
+#define ALU_CHAIN
+Texture2D<float4> sourceData : register(t0);
+#include "loadTexBody.hlsli"
@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 4
+#define LOAD_LINEAR
+#define BINDLESS_UNIFORM
+#define SOURCE_TYPE Texture2D<float4>
+#include "bindless.hlsli"
+#include "loadTexBody.hlsli"
@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 4
+#define LOAD_LINEAR
+#define ROOT_CONSTANTS
+Texture2D<float4> sourceData : register(t0);
+#include "rootBinding.hlsli"
+#include "loadTexBody.hlsli"
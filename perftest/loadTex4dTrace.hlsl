@@ -0,0 +1,4 @@
+#define LOAD_WIDTH 4
+#define TRACE_TEXTURE
+Texture2D<float4> sourceData : register(t0);
+#include "loadTraceBody.hlsli"
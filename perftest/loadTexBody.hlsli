@@ -1,4 +1,3 @@
-#include "hash.hlsli"
 #include "loadConstantsGPU.h"
 
 RWBuffer<float> output : register(u0);
@@ -8,32 +7,32 @@ cbuffer CB0 : register(b0)
 	LoadConstants loadConstants;
 };
 
+#include "accessPattern.hlsli"
+#include "latencyHiding.hlsli"
+
+#ifndef ROOT_SIGNATURE
 #define ROOT_SIGNATURE \
 	"DescriptorTable(" \
 		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
 		"SRV(t0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		PATTERN_SRVS \
 		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
+#endif
 
 #define THREAD_GROUP_DIM 16
 
-groupshared float dummyLDS[THREAD_GROUP_DIM][THREAD_GROUP_DIM];
+groupshared float dummyLDS[THREAD_GROUP_DIM + OCCUPANCY_LDS_FLOATS / THREAD_GROUP_DIM][THREAD_GROUP_DIM];
 
 [RootSignature(ROOT_SIGNATURE)]
 [numthreads(THREAD_GROUP_DIM, THREAD_GROUP_DIM, 1)]
-void main(uint3 tid : SV_DispatchThreadID, uint3 gid : SV_GroupThreadID)
+void main(uint3 tid : SV_DispatchThreadID, uint3 gid : SV_GroupThreadID, uint gix : SV_GroupIndex)
 {
 	float4 value = 0.0;
-	
-#if defined(LOAD_INVARIANT)
-    // All threads load from same address. Index is wave invariant.
-	uint2 htid = 0;
-#elif defined(LOAD_LINEAR)
-	// Linearly increasing starting address.
-	uint2 htid = gid.xy;
-#elif defined(LOAD_RANDOM)
-    // Randomize start address offset (0-3, 0-3)
-	uint2 htid = uint2((hash1(gid.x) & 0x4), (hash1(gid.y) & 0x4));
+#ifdef BINDLESS
+	SOURCE_TYPE sourceData = ResourceDescriptorHeap[BINDLESS_INDEX(gix)];
 #endif
+	
+	uint2 htid = patternStart2d(gid.xy);
 
 	[loop]
 	for (int y = 0; y < 16; ++y)
@@ -45,11 +44,11 @@ void main(uint3 tid : SV_DispatchThreadID, uint3 gid : SV_GroupThreadID)
 			uint2 elemIdx = (htid + uint2(x, y)) | loadConstants.elementsMask;
 
 #if LOAD_WIDTH == 1
-			value += sourceData[elemIdx].xxxx;
+			value += aluChain(sourceData[elemIdx].xxxx);
 #elif LOAD_WIDTH == 2
-			value += sourceData[elemIdx].xyxy;
+			value += aluChain(sourceData[elemIdx].xyxy);
 #elif LOAD_WIDTH == 4
-			value += sourceData[elemIdx].xyzw;
+			value += aluChain(sourceData[elemIdx].xyzw);
 #endif
 		}
 	}
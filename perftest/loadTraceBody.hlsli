@@ -0,0 +1,60 @@
+#include "loadConstantsGPU.h"
+
+// Address trace replay. Thread gix of every group replays traced thread gix % traceThreads: traceLoads
+// float4 element indices from a load major index buffer. Define TRACE_TYPED, TRACE_RAW, TRACE_STRUCTURED
+// or TRACE_TEXTURE (texel rows of TRACE_TEXTURE_WIDTH) to match sourceData.
+
+RWBuffer<float> output : register(u0);
+Buffer<uint> traceIndices : register(t2);
+
+cbuffer CB0 : register(b0)
+{
+	LoadConstants loadConstants;
+};
+
+#define ROOT_SIGNATURE \
+	"DescriptorTable(" \
+		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		"SRV(t0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		"SRV(t2, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
+
+#define THREAD_GROUP_SIZE 256
+
+groupshared float dummyLDS[THREAD_GROUP_SIZE];
+
+[RootSignature(ROOT_SIGNATURE)]
+[numthreads(THREAD_GROUP_SIZE, 1, 1)]
+void main(uint3 tid : SV_DispatchThreadID, uint gix : SV_GroupIndex)
+{
+	float4 value = 0.0;
+	uint thread = gix % loadConstants.traceThreads;
+
+	[loop]
+	for (uint i = 0; i < loadConstants.traceLoads; ++i)
+	{
+		// Mask with runtime constant to prevent unwanted compiler optimizations
+		uint elemIdx = traceIndices[i * loadConstants.traceThreads + thread] | loadConstants.elementsMask;
+
+#if defined(TRACE_RAW)
+		value += asfloat(sourceData.Load4(elemIdx * 16));
+#elif defined(TRACE_TEXTURE)
+		value += sourceData.Load(int3(elemIdx % TRACE_TEXTURE_WIDTH, elemIdx / TRACE_TEXTURE_WIDTH, 0));
+#else
+		value += sourceData[elemIdx];
+#endif
+	}
+
+    // Linear write to LDS (no bank conflicts). Significantly faster than memory loads.
+	dummyLDS[gix] = value.x + value.y + value.z + value.w;
+
+	GroupMemoryBarrierWithGroupSync();
+
+	// This branch is never taken, but the compiler doesn't know it
+	// Optimizer would remove all the memory loads if the data wouldn't be potentially used
+	[branch]
+	if (loadConstants.writeIndex != 0xffffffff)
+	{
+        output[tid.x + tid.y] = dummyLDS[loadConstants.writeIndex];
+    }
+}
@@ -0,0 +1,4 @@
+#define LOAD_WIDTH 4
+#define LOAD_DIVERGENT
+Buffer<float4> sourceData : register(t0);
+#include "loadTypedBody.hlsli"
@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 4
+#define LOAD_INVARIANT
+#define ROOT_CONSTANTS
+Buffer<float4> sourceData : register(t0);
+#include "rootBinding.hlsli"
+#include "loadTypedBody.hlsli"
@@ -0,0 +1,6 @@
+#define LOAD_WIDTH 4
+#define LOAD_LINEAR
+#define BINDLESS_WAVE_UNIFORM
+#define SOURCE_TYPE Buffer<float4>
+#include "bindless.hlsli"
+#include "loadTypedBody.hlsli"
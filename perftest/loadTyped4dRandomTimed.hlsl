@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_RANDOM
+#define WAVE_TIMING
+Buffer<float4> sourceData : register(t0);
+#include "loadTypedBody.hlsli"
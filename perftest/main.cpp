@@ -2,52 +2,941 @@
 #include "directx.h"
 #include "graphicsUtil.h"
 #include "loadConstantsGPU.h"
+#include "kernelDesc.h"
+#include "shaderVerifier.h"
+#include "validation.h"
+#include "inputContent.h"
+#include "transferBench.h"
+#include "placement.h"
+#include "addressTrace.h"
+#include "waveTimer.h"
+#include "timelineTrace.h"
+#include "gpuMarkers.h"
+#include "report.h"
+#include "history.h"
+#include "soak.h"
+#include <algorithm>
 #include <map>
+#include <assert.h>
+#include <stdlib.h>
 #include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+
+struct CommandLineOptions
+{
+	int adapterIndex = 0;
+	unsigned batchSize = 0;
+	unsigned repeatCount = 1;
+	float shaderClockMHz = 0.0f;		// Optional, for loads/clock/CU
+	unsigned computeUnits = 0;			// Optional, for loads/clock/CU
+	bool pipelineStatistics = false;
+	bool verifyShaders = false;
+	bool validate = false;
+	std::vector<InputContentDesc> inputContents;		// Test suite runs once per input content
+	std::vector<PlacementDesc> placements;				// ... and once per memory placement
+	unsigned workingSetMB = 0;			// Buffer of the paged kernels, 0 disables them
+	bool transferBenchmarks = false;
+	unsigned asyncComputeQueues = 0;	// Compute queues for the concurrency test cases, 0 disables them
+	std::string traceFile;				// Address trace replayed by the trace kernels, empty disables them
+	bool waveTiming = false;			// Per wave timing of the instrumented kernels
+	std::string waveTimingFile;			// Optional CSV output of the wave records
+	std::string timelineFile;			// Chrome trace JSON of the frames, empty disables it
+	std::string resultsFile;			// CSV export of the results, empty disables it
+	std::string reportFile;				// Report mode: writes a report of the result files and exits
+	std::vector<std::string> reportInputs;
+	std::string historyFile;			// Results history the run is appended to, empty disables it
+	std::string historyQueryFile;		// History query mode: prints the change points of the history and exits
+	std::string historyFilter;
+	float soakMinutes = 0.0f;			// Soak mode duration after the warm-up frames, 0 disables it
+	std::string soakFile;				// Optional CSV output of the soak time series
+};
+
+// Every input content and memory placement runs the test suite again. A run is about 400 test cases (twice
+// that with -batch), all of them must fit the performance queries of a frame.
+const unsigned maxSuiteRuns = 8;
+
+// Returns null if the options can't be run
+std::optional<CommandLineOptions> parseCommandLine(int argc, char* argv[])
+{
+	CommandLineOptions options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "-batch" && i + 1 < argc)
+		{
+			// Every dispatch of a batch gets at least one of the 1024 rows of the workload
+			int batchSize = std::stoi(argv[++i]);
+			if (batchSize < 2 || batchSize > 1024)
+			{
+				printf("-batch K must be between 2 and 1024\n");
+				return std::nullopt;
+			}
+			options.batchSize = batchSize;
+		}
+		else if (arg == "-repeat" && i + 1 < argc)
+			options.repeatCount = max(std::stoi(argv[++i]), 1);
+		else if (arg == "-clock" && i + 1 < argc)
+			options.shaderClockMHz = std::stof(argv[++i]);
+		else if (arg == "-cus" && i + 1 < argc)
+			options.computeUnits = std::stoi(argv[++i]);
+		else if (arg == "-pipelinestats")
+			options.pipelineStatistics = true;
+		else if (arg == "-verify")
+			options.verifyShaders = true;
+		else if (arg == "-validate")
+			options.validate = true;
+		else if (arg == "-transfer")
+			options.transferBenchmarks = true;
+		else if (arg == "-async" && i + 1 < argc)
+			options.asyncComputeQueues = max(min(std::stoi(argv[++i]), 7), 0);
+		else if (arg == "-trace" && i + 1 < argc)
+			options.traceFile = argv[++i];
+		else if (arg == "-results" && i + 1 < argc)
+			options.resultsFile = argv[++i];
+		else if (arg == "-report" && i + 1 < argc)
+		{
+			options.reportFile = argv[++i];
+			while (i + 1 < argc && argv[i + 1][0] != '-')
+				options.reportInputs.push_back(argv[++i]);
+		}
+		else if (arg == "-history" && i + 1 < argc)
+			options.historyFile = argv[++i];
+		else if (arg == "-historyquery" && i + 1 < argc)
+		{
+			options.historyQueryFile = argv[++i];
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				options.historyFilter = argv[++i];
+		}
+		else if (arg == "-soak" && i + 1 < argc)
+		{
+			options.soakMinutes = max(std::stof(argv[++i]), 0.0f);
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				options.soakFile = argv[++i];
+		}
+		else if (arg == "-timeline" && i + 1 < argc)
+			options.timelineFile = argv[++i];
+		else if (arg == "-wavetiming")
+		{
+			options.waveTiming = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+				options.waveTimingFile = argv[++i];
+		}
+		else if (arg == "-content" && i + 1 < argc)
+		{
+			std::optional<InputContentDesc> content = parseInputContent(argv[++i]);
+			if (!content)
+			{
+				printf("Invalid input content: %s\n", argv[i]);
+				return std::nullopt;
+			}
+			options.inputContents.push_back(*content);
+		}
+		else if (arg == "-placement" && i + 1 < argc)
+		{
+			std::optional<PlacementDesc> placement = parsePlacement(argv[++i]);
+			if (!placement)
+			{
+				printf("Unknown placement: %s\n", argv[i]);
+				return std::nullopt;
+			}
+			options.placements.push_back(*placement);
+		}
+		else if (arg == "-workingset" && i + 1 < argc)
+		{
+			// Byte addresses of the raw kernel are 32-bit
+			int megabytes = std::stoi(argv[++i]);
+			if (megabytes < 1 || megabytes > 1024)
+			{
+				printf("-workingset MB must be between 1 and 1024\n");
+				return std::nullopt;
+			}
+			options.workingSetMB = megabytes;
+		}
+		else if (arg[0] != '-')
+			options.adapterIndex = std::stoi(arg);
+		else
+			printf("Unknown argument: %s\n", arg.c_str());
+	}
+
+	// A soak runs for hours, the recorders that keep the data of every frame would grow without bound
+	if (options.soakMinutes > 0.0f && (!options.timelineFile.empty() || options.waveTiming))
+	{
+		printf("-timeline and -wavetiming are ignored with -soak\n");
+		options.timelineFile.clear();
+		options.waveTiming = false;
+	}
+
+	unsigned contents = max((unsigned)options.inputContents.size(), 1u);
+	unsigned placements = max((unsigned)options.placements.size(), 1u);
+	if (contents * placements * (options.batchSize ? 2 : 1) > maxSuiteRuns)
+	{
+		printf("Too many test suite runs: %u input contents x %u placements%s. At most %u fit in a frame, %u with -batch.\n",
+			contents, placements, options.batchSize ? " with -batch" : "", maxSuiteRuns, maxSuiteRuns / 2);
+		return std::nullopt;
+	}
+	return options;
+}
+
+struct TestCaseInfo
+{
+	std::string name;
+	unsigned dispatchCount = 1;		// Dispatches per repetition
+	unsigned repeatCount = 1;		// Repetitions between the timestamp pair
+	bool uavBarriers = true;
+	bool calibration = false;
+	int serializedTestCase = -1;	// Overlapped batches: the matching batch with UAV barriers between dispatches
+	std::vector<int> serialTestCases;	// Concurrent test cases: the same workloads run alone, one per queue
+	int syncCalibration = -1;		// Queue test cases: the same submits and fences without any work
+	int baselineTestCase = -1;		// Compared variants: binding variants vs the descriptor table binding, AoS vs SoA
+	const char* baselineLabel = nullptr;
+	std::string sweep;				// Sweeps: curve name, and the swept value of this point
+	unsigned sweepValue = 0;
+	bool trace = false;				// Address trace replay, also summarized per resource type after the results
+
+	// Work done by a single repetition, all of its dispatches. Used for the derived throughput metrics.
+	uint64_t threadsPerRepetition = 0;
+	unsigned loadsPerThread = 0;
+	unsigned loadWidth = 0;			// Channels per load
+	unsigned bytesPerLoad = 0;
+	uint64_t copyBytes = 0;			// Copy queue workloads
+
+	const ShaderVerification* verification = nullptr;		// Null if shader verification is disabled
+	int validation = -1;									// Validator result index, -1 if not validated
+};
+
+unsigned getBytesPerLoad(const KernelDesc& kernel, const ShaderResourceView& source)
+{
+	switch (kernel.resource)
+	{
+	case KernelResource::Raw:
+		return getElementBytes(kernel.element) * kernel.loadWidth;
+	case KernelResource::Constant:
+	case KernelResource::StructAos:
+	case KernelResource::StructAosRaw:
+	case KernelResource::StructSoa:
+		return 16;
+	case KernelResource::Structured:
+		return source.desc->Buffer.StructureByteStride;
+	case KernelResource::Typed:
+		return getFormatBytes(source.desc->Format);
+	default:
+		return getFormatBytes(source.resource->GetDesc().Format);
+	}
+}
 
 class BenchTest
 {
 public:
-	BenchTest(DirectXDevice& dx, const UnorderedAccessView& output) : dx(dx), output(output), testCaseNumber(0)
+	BenchTest(DirectXDevice& dx, const UnorderedAccessView& output, const ShaderResourceView& gatherIndices, const ShaderResourceView& traceIndices, const CommandLineOptions& options, ShaderVerifier* verifier, Validator* validator) :
+		dx(dx), output(output), gatherIndices(gatherIndices), traceIndices(traceIndices), verifier(verifier), validator(validator), batchSize(options.batchSize), repeatCount(options.repeatCount), testCaseNumber(0)
+	{
+	}
+
+	// Validation dispatches are recorded once, in front of the timed dispatches of a single frame
+	void beginFrame(bool validationFrame = false)
 	{
+		testCaseNumber = 0;
+		this->validationFrame = validationFrame && validator;
+	}
+
+	// Measures the fixed costs that are included in every test case: a back-to-back timestamp pair,
+	// and a single thread group dispatch of an empty kernel.
+	void calibrate(ComputePSO& emptyShader)
+	{
+		const uint3 workloadGroupSize(256, 1, 1);
+
+		timestampCalibration = (int)addTestCase({ .name = "Calibration: timestamp pair", .dispatchCount = 0, .calibration = true });
+		QueryHandle query = dx.startPerformanceQuery(testCaseNumber, testCases[testCaseNumber].name);
+		dx.endPerformanceQuery(query);
+		testCaseNumber++;
+
+		emptyDispatchCalibration = (int)addTestCase({
+			.name = "Calibration: empty dispatch",
+			.repeatCount = repeatCount,
+			.calibration = true,
+			.threadsPerRepetition = workloadGroupSize.x });
+		query = dx.startPerformanceQuery(testCaseNumber, testCases[testCaseNumber].name);
+		for (unsigned i = 0; i < repeatCount; i++)
+			dx.dispatch(emptyShader, workloadGroupSize, workloadGroupSize, {}, {}, {}, {});
+		dx.endPerformanceQuery(query);
+		testCaseNumber++;
 	}
 
 	void testCase(ComputePSO& shader, ID3D12Resource* cb, const ShaderResourceView& source, const std::string& name)
 	{
+		runTestCase(shader, cb, source, nullptr, name);
+	}
+
+	void testCaseWithSampler(ComputePSO& shader, ID3D12Resource* cb, const ShaderResourceView& source, const SamplerState& sampler, const std::string& name)
+	{
+		runTestCase(shader, cb, source, &sampler, name);
+	}
+
+	// Test case reported against an earlier test case baselineName doing the same work another way. Binding
+	// variants (bindless, root descriptors, root constants) compare against the descriptor table binding,
+	// AoS struct layouts against SoA, and the extended access patterns against the linear pattern.
+	void comparedTestCase(
+		ComputePSO& shader,
+		ID3D12Resource* cb,
+		const ShaderResourceView& source,
+		const std::string& name,
+		const std::string& baselineName,
+		const char* baselineLabel,
+		const SamplerState* sampler = nullptr)
+	{
+		unsigned first = testCaseNumber;
+		runTestCase(shader, cb, source, sampler, name);
+
+		// Batch mode records several test cases, each one compares against the same kind of batch
+		for (unsigned id = first; id < testCaseNumber; id++)
+		{
+			std::string batchSuffix = testCases[id].name.substr(name.length() + nameSuffix.length());
+			testCases[id].baselineTestCase = findTestCase(baselineName + nameSuffix + batchSuffix);
+			testCases[id].baselineLabel = baselineLabel;
+		}
+	}
+
+	// Point of a sweep. The sweep test cases are also reported as a curve after the results.
+	void sweepTestCase(
+		ComputePSO& shader,
+		ID3D12Resource* cb,
+		const ShaderResourceView& source,
+		const SamplerState* sampler,
+		const std::string& name,
+		const std::string& sweep,
+		unsigned sweepValue)
+	{
+		unsigned first = testCaseNumber;
+		runTestCase(shader, cb, source, sampler, name);
+
+		// Batch mode: one curve per kind of batch
+		for (unsigned id = first; id < testCaseNumber; id++)
+		{
+			std::string batchSuffix = testCases[id].name.substr(name.length() + nameSuffix.length());
+			testCases[id].sweep = sweep + nameSuffix + batchSuffix;
+			testCases[id].sweepValue = sweepValue;
+		}
+	}
+
+	// Address trace replay. The trace kernels loop over the traced loads of a thread, the loads per thread
+	// of the throughput metrics come from the trace.
+	void traceTestCase(ComputePSO& shader, ID3D12Resource* cb, const ShaderResourceView& source, const std::string& name, unsigned loadsPerThread)
+	{
+		unsigned first = testCaseNumber;
+		runTestCase(shader, cb, source, nullptr, name);
+
+		for (unsigned id = first; id < testCaseNumber; id++)
+		{
+			testCases[id].loadsPerThread = loadsPerThread;
+			testCases[id].trace = true;
+		}
+	}
+
+	// Workload of a concurrency test case. A null shader is a buffer copy, for copy queues.
+	struct QueueWorkload
+	{
+		unsigned queue;		// DirectXDevice queue index, 0 is the direct queue
+		const ComputePSO* shader = nullptr;
+		ID3D12Resource* cb = nullptr;
+		const ShaderResourceView* source = nullptr;
+		const SamplerState* sampler = nullptr;
+	};
+
+	// Creates the queues of the concurrency test cases: computeQueueCount compute queues and a copy queue.
+	// Must be called outside of a frame.
+	void addQueues(unsigned computeQueueCount)
+	{
+		for (unsigned i = 0; i < computeQueueCount; i++)
+		{
+			computeQueues.push_back(dx.addQueue(D3D12_COMMAND_LIST_TYPE_COMPUTE));
+			queueNames.push_back("compute " + std::to_string(i + 1));
+		}
+		copyQueue = dx.addQueue(D3D12_COMMAND_LIST_TYPE_COPY);
+		queueNames.push_back("copy");
+
+		// The kernels never write, but a UAV can't be used by several queues at the same time. One output per queue.
+		for (unsigned queue = 1; queue < queueNames.size(); queue++)
+		{
+			queueOutputBuffers.push_back(dx.createBuffer(2048, 4));
+			queueOutputs.push_back(dx.createTypedUAV(queueOutputBuffers.back().Get(), 2048, DXGI_FORMAT_R32_FLOAT));
+		}
+
+		copySource = dx.createBuffer(copyBytes / 4, 4);
+		copyDest = dx.createBuffer(copyBytes / 4, 4);
+	}
+
+	unsigned getComputeQueueCount() const { return (unsigned)computeQueues.size(); }
+	unsigned getComputeQueue(unsigned index) const { return computeQueues[index]; }
+	unsigned getCopyQueue() const { return copyQueue; }
+
+	// Runs every workload alone on its queue, then all of them concurrently. The concurrent test case is
+	// compared against the sum of the alone test cases. Records queue submits, so it must come after the
+	// validation dispatches of the frame: submits decay the output buffer to the common state.
+	void concurrentTestCase(const std::vector<QueueWorkload>& workloads, const std::string& baseName)
+	{
+		const std::string name = baseName + nameSuffix;
+		std::vector<int> serialTestCases;
+		for (const QueueWorkload& workload : workloads)
+		{
+			const std::string partName = name + " (" + queueNames[workload.queue] + " alone)";
+			int syncCalibration = (int)testCaseNumber;
+			recordQueueTestCase({ workload }, "Calibration: " + partName, true);
+			serialTestCases.push_back((int)testCaseNumber);
+			recordQueueTestCase({ workload }, partName);
+			testCases[serialTestCases.back()].syncCalibration = syncCalibration;
+		}
+
+		int syncCalibration = (int)testCaseNumber;
+		recordQueueTestCase(workloads, "Calibration: " + name + " (concurrent)", true);
+		int concurrentTestCaseNumber = (int)testCaseNumber;
+		recordQueueTestCase(workloads, name + " (concurrent)");
+		testCases[concurrentTestCaseNumber].serialTestCases = serialTestCases;
+		testCases[concurrentTestCaseNumber].syncCalibration = syncCalibration;
+	}
+
+	// Appended to the test case names. Identifies the input content if the suite runs several times.
+	void setNameSuffix(const std::string& suffix) { nameSuffix = suffix; }
+
+	const std::vector<TestCaseInfo>& getTestCases() const { return testCases; }
+	int getTimestampCalibration() const { return timestampCalibration; }
+	int getEmptyDispatchCalibration() const { return emptyDispatchCalibration; }
+
+private:
+	void runTestCase(ComputePSO& shader, ID3D12Resource* cb, const ShaderResourceView& source, const SamplerState* sampler, const std::string& baseName)
+	{
+		const std::string name = baseName + nameSuffix;
 		const uint3 workloadThreadCount(1024, 1024, 1);
 		const uint3 workloadGroupSize(256, 1, 1);
 
+		// The metrics and the verification need the load count and width encoded in the kernel name
+		std::optional<KernelDesc> kernel = parseKernelName(shader.getName());
+		if (!kernel)
+		{
+			printf("\nCan't parse the kernel name %s\n", shader.getName().c_str());
+			exit(1);
+		}
+		TestCaseInfo workload = {
+			.loadsPerThread = kernel->loadsPerThread,
+			.loadWidth = kernel->loadWidth,
+			.bytesPerLoad = getBytesPerLoad(*kernel, source) };
+
+		// Verified once per kernel, results are cached by the verifier
+		if (verifier)
+			workload.verification = &verifier->verify(shader.getName(), *kernel);
+
+		if (validationFrame)
+			workload.validation = (int)validator->recordTestCase(name, *kernel, shader, cb, source, sampler, workloadThreadCount, workloadGroupSize);
+
+		if (batchSize == 0)
+		{
+			recordTestCase(workload, shader, cb, source, sampler, name, workloadThreadCount, 1, true);
+			return;
+		}
+
+		// Batch mode: the same workload split into batchSize small back-to-back dispatches. Recorded twice:
+		// serialized by a UAV barrier after every dispatch, and with a single barrier after the last one.
+		// The kernels never write their output, so overlapping dispatches is safe.
+		int serializedTestCase = (int)testCaseNumber;
+		recordTestCase(workload, shader, cb, source, sampler, name + " batch serialized", workloadThreadCount, batchSize, true);
+		recordTestCase(workload, shader, cb, source, sampler, name + " batch overlapped", workloadThreadCount, batchSize, false);
+		testCases[serializedTestCase + 1].serializedTestCase = serializedTestCase;
+	}
+
+	void recordTestCase(
+		TestCaseInfo info,
+		ComputePSO& shader,
+		ID3D12Resource* cb,
+		const ShaderResourceView& source,
+		const SamplerState* sampler,
+		const std::string& name,
+		uint3 threadCount,
+		unsigned dispatchCount,
+		bool uavBarriers)
+	{
+		const uint3 workloadGroupSize(256, 1, 1);
+
+		info.name = name;
+		info.dispatchCount = dispatchCount;
+		info.repeatCount = repeatCount;
+		info.uavBarriers = uavBarriers;
+		info.threadsPerRepetition = (uint64_t)threadCount.x * threadCount.y * threadCount.z;
+		addTestCase(info);
+
+		// Repetitions amortize the timestamp and dispatch overhead of short kernels
 		QueryHandle query = dx.startPerformanceQuery(testCaseNumber, name);
-		dx.dispatch(shader, workloadThreadCount, workloadGroupSize, { cb }, { &source }, { &output }, {});
+		for (unsigned repeat = 0; repeat < repeatCount; repeat++)
+		{
+			for (unsigned i = 0; i < dispatchCount; i++)
+			{
+				// The rows of threadCount are split exactly, the first dispatches take the remainder
+				uint3 dispatchThreadCount(threadCount.x, threadCount.y / dispatchCount + (i < threadCount.y % dispatchCount ? 1 : 0), threadCount.z);
+
+				// Last dispatch of a batch always has a barrier, so the end timestamp covers the whole batch
+				bool uavBarrier = uavBarriers || i == dispatchCount - 1;
+				if (sampler)
+					dx.dispatch(shader, dispatchThreadCount, workloadGroupSize, { cb }, { &source, &gatherIndices, &traceIndices }, { &output }, { sampler }, uavBarrier);
+				else
+					dx.dispatch(shader, dispatchThreadCount, workloadGroupSize, { cb }, { &source, &gatherIndices, &traceIndices }, { &output }, {}, uavBarrier);
+			}
+		}
 		dx.endPerformanceQuery(query);
 
 		testCaseNumber++;
 	}
 
-	void testCaseWithSampler(ComputePSO& shader, ID3D12Resource* cb, const ShaderResourceView& source, const SamplerState& sampler, const std::string& name)
+	// A calibration records the submits and fences of the workloads, but none of their work
+	void recordQueueTestCase(const std::vector<QueueWorkload>& workloads, const std::string& name, bool calibration = false)
 	{
 		const uint3 workloadThreadCount(1024, 1024, 1);
 		const uint3 workloadGroupSize(256, 1, 1);
 
-		QueryHandle query = dx.startPerformanceQuery(testCaseNumber, name);
-		dx.dispatch(shader, workloadThreadCount, workloadGroupSize, { cb }, { &source }, { &output }, { &sampler });
+		TestCaseInfo info = {
+			.name = name,
+			.dispatchCount = (unsigned)workloads.size(),
+			.repeatCount = repeatCount,
+			.calibration = calibration };
+		if (!calibration && workloads.size() == 1 && workloads[0].shader)
+		{
+			std::optional<KernelDesc> kernel = parseKernelName(workloads[0].shader->getName());
+			if (!kernel)
+			{
+				printf("\nCan't parse the kernel name %s\n", workloads[0].shader->getName().c_str());
+				exit(1);
+			}
+			info.threadsPerRepetition = (uint64_t)workloadThreadCount.x * workloadThreadCount.y * workloadThreadCount.z;
+			info.loadsPerThread = kernel->loadsPerThread;
+			info.loadWidth = kernel->loadWidth;
+			info.bytesPerLoad = getBytesPerLoad(*kernel, *workloads[0].source);
+			if (verifier)
+				info.verification = &verifier->verify(workloads[0].shader->getName(), *kernel);
+		}
+		else if (!calibration && workloads.size() == 1)
+		{
+			info.copyBytes = copyBytes;
+		}
+		addTestCase(info);
+
+		auto recordWorkload = [&](const QueueWorkload& workload)
+		{
+			const UnorderedAccessView& queueOutput = workload.queue ? queueOutputs[workload.queue - 1] : output;
+			for (unsigned repeat = 0; repeat < (calibration ? 0 : repeatCount); repeat++)
+			{
+				if (!workload.shader)
+					dx.copyBuffer(copyDest.Get(), 0, copySource.Get(), 0, copyBytes);
+				else if (workload.sampler)
+					dx.dispatch(*workload.shader, workloadThreadCount, workloadGroupSize, { workload.cb }, { workload.source }, { &queueOutput }, { workload.sampler });
+				else
+					dx.dispatch(*workload.shader, workloadThreadCount, workloadGroupSize, { workload.cb }, { workload.source }, { &queueOutput });
+			}
+		};
+
+		// Timestamps are taken on the direct queue. The other queues wait for the start timestamp, and the
+		// direct queue waits for all of them before the end timestamp. An alone test case pays these
+		// submit and fence costs once for its queue, the concurrent test case once for all of them:
+		// both subtract their own calibration, so the serial sum doesn't count the sync costs N times.
+		QueryHandle query = dx.startPerformanceQuery(testCaseNumber, name, true);
+		SyncPoint start = dx.submit(0);
+
+		std::vector<SyncPoint> done;
+		for (const QueueWorkload& workload : workloads)
+		{
+			if (workload.queue == 0)
+				continue;
+			dx.waitForSyncPoint(workload.queue, start);
+			dx.setRecordingQueue(workload.queue);
+			recordWorkload(workload);
+			done.push_back(dx.submit(workload.queue));
+		}
+
+		dx.setRecordingQueue(0);
+		for (const QueueWorkload& workload : workloads)
+		{
+			if (workload.queue == 0)
+				recordWorkload(workload);
+		}
+		dx.submit(0);
+
+		for (SyncPoint syncPoint : done)
+			dx.waitForSyncPoint(0, syncPoint);
 		dx.endPerformanceQuery(query);
 
 		testCaseNumber++;
 	}
 
-private:
+	int findTestCase(const std::string& name) const
+	{
+		for (size_t id = 0; id < testCases.size(); id++)
+		{
+			if (testCases[id].name == name)
+				return (int)id;
+		}
+		return -1;
+	}
+
+	unsigned addTestCase(const TestCaseInfo& info)
+	{
+		// Test cases are recorded in the same order every frame
+		if (testCaseNumber >= testCases.size())
+			testCases.push_back(info);
+		return testCaseNumber;
+	}
+
 	DirectXDevice& dx;
 	const UnorderedAccessView& output;
+	const ShaderResourceView& gatherIndices;		// Index buffer of the indexed pattern kernels (t1)
+	const ShaderResourceView& traceIndices;			// Index buffer of the address trace kernels (t2)
+	ShaderVerifier* verifier;
+	Validator* validator;
+	bool validationFrame = false;
+	std::string nameSuffix;
+	unsigned batchSize;
+	unsigned repeatCount;
 	unsigned testCaseNumber;
+	std::vector<TestCaseInfo> testCases;
+	int timestampCalibration = -1;
+	int emptyDispatchCalibration = -1;
+
+	// Concurrency test cases
+	static constexpr unsigned copyBytes = 32 * 1024 * 1024;
+	std::vector<std::string> queueNames = { "direct" };
+	std::vector<unsigned> computeQueues;
+	unsigned copyQueue = 0;
+	std::vector<ComPtr<ID3D12Resource>> queueOutputBuffers;
+	std::vector<UnorderedAccessView> queueOutputs;		// Queue index - 1
+	ComPtr<ID3D12Resource> copySource;
+	ComPtr<ID3D12Resource> copyDest;
 };
 
+// Texel rows of the address trace texture
+unsigned getTraceTextureRows(unsigned traceElements)
+{
+	return (traceElements + TRACE_TEXTURE_WIDTH - 1) / TRACE_TEXTURE_WIDTH;
+}
+
+// Input resources of the test suite, filled with one input content and allocated with one memory placement
+struct InputResources
+{
+	InputResources(DirectXDevice& dx, const InputContentDesc& content, const PlacementDesc& placement, unsigned workingSetBytes, unsigned traceElements, Validator* validator, const std::string& nameSuffix, bool bindless) :
+		nameSuffix(nameSuffix),
+		placer(dx, placement, (UINT64)workingSetBytes + (UINT64)traceElements * 16, (UINT64)getTraceTextureRows(traceElements) * TRACE_TEXTURE_WIDTH * 16),
+		bufferInput(placer.createBuffer(1024, 16)),
+		bufferInputStructured4(placer.createBuffer(1024, 4)),
+		bufferInputStructured8(placer.createBuffer(1024, 8)),
+		bufferInputStructured16(placer.createBuffer(1024, 16)),
+		bufferInputStruct(placer.createBuffer(STRUCT_COUNT * 16, 16)),
+		bufferPaged(workingSetBytes ? placer.createBuffer(workingSetBytes / 16, 16) : nullptr),
+		bufferTrace(traceElements ? placer.createBuffer(traceElements, 16) : nullptr),
+
+		// SRVs for benchmarking different buffer view formats/types
+		typedSRV_R8(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R8_UNORM)),
+		typedSRV_R16F(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R16_FLOAT)),
+		typedSRV_R32F(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R32_FLOAT)),
+		typedSRV_RG8(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R8G8_UNORM)),
+		typedSRV_RG16F(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R16G16_FLOAT)),
+		typedSRV_RG32F(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R32G32_FLOAT)),
+		typedSRV_RGBA8(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R8G8B8A8_UNORM)),
+		typedSRV_RGBA16F(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R16G16B16A16_FLOAT)),
+		typedSRV_RGBA32F(dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R32G32B32A32_FLOAT)),
+		structuredSRV_R32F(dx.createStructuredSRV(bufferInputStructured4.Get(), 1024, 4)),
+		structuredSRV_RG32F(dx.createStructuredSRV(bufferInputStructured8.Get(), 1024, 8)),
+		structuredSRV_RGBA32F(dx.createStructuredSRV(bufferInputStructured16.Get(), 1024, 16)),
+		structuredSRV_16(dx.createStructuredSRV(bufferInputStructured4.Get(), 1024, 2)),
+		byteAddressSRV(dx.createByteAddressSRV(bufferInput.Get(), 1024)),
+
+		// Struct layout SRVs. All view the same 64 KB buffer: AoS structs of 32-256 bytes or 16 SoA planes.
+		structSRV_32(dx.createStructuredSRV(bufferInputStruct.Get(), STRUCT_COUNT, 32)),
+		structSRV_64(dx.createStructuredSRV(bufferInputStruct.Get(), STRUCT_COUNT, 64)),
+		structSRV_128(dx.createStructuredSRV(bufferInputStruct.Get(), STRUCT_COUNT, 128)),
+		structSRV_256(dx.createStructuredSRV(bufferInputStruct.Get(), STRUCT_COUNT, 256)),
+		structSoaSRV(dx.createStructuredSRV(bufferInputStruct.Get(), STRUCT_COUNT * 16, 16)),
+		structRawSRV(dx.createByteAddressSRV(bufferInputStruct.Get(), STRUCT_COUNT * 16 * 4)),
+
+		// Paged kernel SRVs, the whole working set
+		pagedTypedSRV(bufferPaged ? dx.createTypedSRV(bufferPaged.Get(), workingSetBytes / 16, DXGI_FORMAT_R32G32B32A32_FLOAT) : ShaderResourceView()),
+		pagedByteAddressSRV(bufferPaged ? dx.createByteAddressSRV(bufferPaged.Get(), workingSetBytes / 4) : ShaderResourceView()),
+
+		// Address trace SRVs, every float4 element the trace reads
+		traceTypedSRV(bufferTrace ? dx.createTypedSRV(bufferTrace.Get(), traceElements, DXGI_FORMAT_R32G32B32A32_FLOAT) : ShaderResourceView()),
+		traceByteAddressSRV(bufferTrace ? dx.createByteAddressSRV(bufferTrace.Get(), traceElements * 4) : ShaderResourceView()),
+		traceStructuredSRV(bufferTrace ? dx.createStructuredSRV(bufferTrace.Get(), traceElements, 16) : ShaderResourceView()),
+
+		// Create input textures
+		texR8(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R8_UNORM, 1)),
+		texR16F(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R16_FLOAT, 1)),
+		texR32F(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R32_FLOAT, 1)),
+		texRG8(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R8G8_UNORM, 1)),
+		texRG16F(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R16G16_FLOAT, 1)),
+		texRG32F(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R32G32_FLOAT, 1)),
+		texRGBA8(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R8G8B8A8_UNORM, 1)),
+		texRGBA16F(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R16G16B16A16_FLOAT, 1)),
+		texRGBA32F(placer.createTexture2d(uint2(32, 32), DXGI_FORMAT_R32G32B32A32_FLOAT, 1)),
+		texTrace(traceElements ? placer.createTexture2d(uint2(TRACE_TEXTURE_WIDTH, (int)getTraceTextureRows(traceElements)), DXGI_FORMAT_R32G32B32A32_FLOAT, 1) : nullptr),
+
+		// Texture SRVs
+		texSRV_R8(dx.createSRV(texR8.Get())),
+		texSRV_R16F(dx.createSRV(texR16F.Get())),
+		texSRV_R32F(dx.createSRV(texR32F.Get())),
+		texSRV_RG8(dx.createSRV(texRG8.Get())),
+		texSRV_RG16F(dx.createSRV(texRG16F.Get())),
+		texSRV_RG32F(dx.createSRV(texRG32F.Get())),
+		texSRV_RGBA8(dx.createSRV(texRGBA8.Get())),
+		texSRV_RGBA16F(dx.createSRV(texRGBA16F.Get())),
+		texSRV_RGBA32F(dx.createSRV(texRGBA32F.Get())),
+		traceTexSRV(texTrace ? dx.createSRV(texTrace.Get()) : ShaderResourceView()),
+
+		loadCB(dx.createConstantBuffer(sizeof(LoadConstants))),
+		loadCBUnaligned(dx.createConstantBuffer(sizeof(LoadConstants))),
+		loadWithArrayCB(dx.createConstantBuffer(sizeof(LoadConstantsWithArray))),
+		bindlessTypedCB(bindless ? dx.createConstantBuffer(sizeof(LoadConstants)) : nullptr),
+		bindlessByteAddressCB(bindless ? dx.createConstantBuffer(sizeof(LoadConstants)) : nullptr),
+		bindlessStructuredCB(bindless ? dx.createConstantBuffer(sizeof(LoadConstants)) : nullptr),
+		bindlessTexCB(bindless ? dx.createConstantBuffer(sizeof(LoadConstants)) : nullptr),
+		pagedCB(bufferPaged ? dx.createConstantBuffer(sizeof(LoadConstants)) : nullptr)
+	{
+		// Fill the inputs through staging buffers. Undefined content leaves them uninitialized.
+		if (content.content != InputContent::Undefined)
+		{
+			std::vector<ID3D12Resource*> buffers = { bufferInput.Get(), bufferInputStructured4.Get(), bufferInputStructured8.Get(), bufferInputStructured16.Get(), bufferInputStruct.Get() };
+			if (bufferPaged)
+				buffers.push_back(bufferPaged.Get());
+			if (bufferTrace)
+				buffers.push_back(bufferTrace.Get());
+			if (placement.placement == MemoryPlacement::Aliased)
+			{
+				// Aliased buffers share their memory. Fill the largest, the others see the start of it.
+				ID3D12Resource* largest = *std::max_element(buffers.begin(), buffers.end(),
+					[](ID3D12Resource* a, ID3D12Resource* b) { return a->GetDesc().Width < b->GetDesc().Width; });
+				std::vector<unsigned char> data = generateBufferContent(content, (unsigned)largest->GetDesc().Width);
+				dx.uploadBuffer(largest, data.data(), (unsigned)data.size());
+				if (validator)
+				{
+					for (ID3D12Resource* buffer : buffers)
+						validator->setSourceData(buffer, std::vector<unsigned char>(data.begin(), data.begin() + buffer->GetDesc().Width));
+				}
+			}
+			else
+			{
+				for (ID3D12Resource* buffer : buffers)
+				{
+					std::vector<unsigned char> data = generateBufferContent(content, (unsigned)buffer->GetDesc().Width);
+					dx.uploadBuffer(buffer, data.data(), (unsigned)data.size());
+					if (validator)
+						validator->setSourceData(buffer, std::move(data));
+				}
+			}
+			std::vector<ID3D12Resource*> textures = { texR8.Get(), texR16F.Get(), texR32F.Get(), texRG8.Get(), texRG16F.Get(), texRG32F.Get(), texRGBA8.Get(), texRGBA16F.Get(), texRGBA32F.Get() };
+			if (texTrace)
+				textures.push_back(texTrace.Get());
+			for (ID3D12Resource* texture : textures)
+			{
+				D3D12_RESOURCE_DESC desc = texture->GetDesc();
+				std::vector<unsigned char> data = generateTextureContent(content, uint2((int)desc.Width, (int)desc.Height), desc.Format);
+				dx.uploadTexture2d(texture, data.data());
+				if (validator)
+					validator->setSourceData(texture, std::move(data));
+			}
+		}
+
+		// Setup the constant buffer
+		LoadConstants loadConstants;
+		loadConstants.elementsMask = 0;				// Dummy mask to prevent unwanted compiler optimizations
+		loadConstants.writeIndex = 0xffffffff;		// Never write
+		loadConstants.readStartAddress = 0;			// Aligned
+		loadConstants.patternWays = PATTERN_WAYS;
+		loadConstants.aluOps = 0;
+		loadConstants.aluScale = 1.0f;				// Identity ALU ops
+		loadConstants.aluBias = 0.0f;
+		loadConstants.pageStride = 0;
+		dx.updateConstantBuffer(loadCB.Get(), loadConstants);
+		if (validator)
+			validator->setConstants(loadCB.Get(), &loadConstants, sizeof(loadConstants));
+		loadConstants.readStartAddress = 4;			// Unaligned
+		dx.updateConstantBuffer(loadCBUnaligned.Get(), loadConstants);
+		if (validator)
+			validator->setConstants(loadCBUnaligned.Get(), &loadConstants, sizeof(loadConstants));
+
+		// Bindless kernels: aligned constants and the heap index of the source descriptors. The kernels
+		// pick one of the copies, all of them view the same resource.
+		if (bindless)
+		{
+			loadConstants.readStartAddress = 0;
+			std::pair<ID3D12Resource*, const ShaderResourceView*> bindlessSources[] = {
+				{ bindlessTypedCB.Get(), &typedSRV_RGBA8 },
+				{ bindlessByteAddressCB.Get(), &byteAddressSRV },
+				{ bindlessStructuredCB.Get(), &structuredSRV_RGBA32F },
+				{ bindlessTexCB.Get(), &texSRV_RGBA8 } };
+			for (auto [cb, view] : bindlessSources)
+			{
+				loadConstants.descriptorIndex = dx.createBindlessSRV(*view, BINDLESS_DESCRIPTOR_COPIES);
+				dx.updateConstantBuffer(cb, loadConstants);
+				if (validator)
+					validator->setConstants(cb, &loadConstants, sizeof(loadConstants));
+			}
+		}
+
+		// Paged kernels: the threads of a group evenly spread over the working set, 256 float4 loads each
+		loadConstants.readStartAddress = 0;
+		if (bufferPaged)
+		{
+			loadConstants.pageStride = workingSetBytes / 16 / 256;
+			dx.updateConstantBuffer(pagedCB.Get(), loadConstants);
+			if (validator)
+				validator->setConstants(pagedCB.Get(), &loadConstants, sizeof(loadConstants));
+			loadConstants.pageStride = 0;
+		}
+
+		// Divergence sweep: the divergent pattern with 1, 2, 4 ... MAX_PATTERN_WAYS addresses per wave
+		for (unsigned ways = 1; ways <= MAX_PATTERN_WAYS; ways *= 2)
+		{
+			loadConstants.patternWays = ways;
+			ComPtr<ID3D12Resource> cb = dx.createConstantBuffer(sizeof(LoadConstants));
+			dx.updateConstantBuffer(cb.Get(), loadConstants);
+			if (validator)
+				validator->setConstants(cb.Get(), &loadConstants, sizeof(loadConstants));
+			divergenceCBs.push_back(cb);
+		}
+
+		// Latency hiding sweep: 0, 1, 4 ... MAX_ALU_OPS dependent ALU ops per load
+		loadConstants.patternWays = PATTERN_WAYS;
+		for (unsigned aluOps = 0; aluOps <= MAX_ALU_OPS; aluOps = aluOps ? aluOps * 4 : 1)
+		{
+			loadConstants.aluOps = aluOps;
+			ComPtr<ID3D12Resource> cb = dx.createConstantBuffer(sizeof(LoadConstants));
+			dx.updateConstantBuffer(cb.Get(), loadConstants);
+			if (validator)
+				validator->setConstants(cb.Get(), &loadConstants, sizeof(loadConstants));
+			aluCBs.push_back({ aluOps, cb });
+		}
+
+		// Setup constant buffer with float4 array for constant buffer load benchmarking
+		LoadConstantsWithArray loadConstantsWithArray;
+		loadConstantsWithArray.elementsMask = 0;				// Dummy mask to prevent unwanted compiler optimizations
+		loadConstantsWithArray.writeIndex = 0xffffffff;			// Never write
+		loadConstantsWithArray.readStartAddress = 0;			// Aligned
+		loadConstantsWithArray.patternWays = PATTERN_WAYS;
+		loadConstantsWithArray.aluOps = 0;
+		loadConstantsWithArray.aluScale = 1.0f;
+		loadConstantsWithArray.aluBias = 0.0f;
+		loadConstantsWithArray.pageStride = 0;
+		std::vector<unsigned char> arrayData = generateBufferContent(content, sizeof(loadConstantsWithArray.benchmarkArray));
+		memcpy(loadConstantsWithArray.benchmarkArray, arrayData.data(), arrayData.size());
+		dx.updateConstantBuffer(loadWithArrayCB.Get(), loadConstantsWithArray);
+		if (validator)
+			validator->setConstants(loadWithArrayCB.Get(), &loadConstantsWithArray, sizeof(loadConstantsWithArray));
+	}
+
+	std::string nameSuffix;
+	ResourcePlacer placer;
+
+	ComPtr<ID3D12Resource> bufferInput;
+	ComPtr<ID3D12Resource> bufferInputStructured4;
+	ComPtr<ID3D12Resource> bufferInputStructured8;
+	ComPtr<ID3D12Resource> bufferInputStructured16;
+	ComPtr<ID3D12Resource> bufferInputStruct;
+	ComPtr<ID3D12Resource> bufferPaged;		// Null without -workingset
+	ComPtr<ID3D12Resource> bufferTrace;		// Null without -trace
+
+	ShaderResourceView typedSRV_R8;
+	ShaderResourceView typedSRV_R16F;
+	ShaderResourceView typedSRV_R32F;
+	ShaderResourceView typedSRV_RG8;
+	ShaderResourceView typedSRV_RG16F;
+	ShaderResourceView typedSRV_RG32F;
+	ShaderResourceView typedSRV_RGBA8;
+	ShaderResourceView typedSRV_RGBA16F;
+	ShaderResourceView typedSRV_RGBA32F;
+	ShaderResourceView structuredSRV_R32F;
+	ShaderResourceView structuredSRV_RG32F;
+	ShaderResourceView structuredSRV_RGBA32F;
+	ShaderResourceView structuredSRV_16;		// Native 16-bit scalars. Wider 16-bit vectors use the 4 and 8 byte strides.
+	ShaderResourceView byteAddressSRV;
+	ShaderResourceView structSRV_32;
+	ShaderResourceView structSRV_64;
+	ShaderResourceView structSRV_128;
+	ShaderResourceView structSRV_256;
+	ShaderResourceView structSoaSRV;
+	ShaderResourceView structRawSRV;
+	ShaderResourceView pagedTypedSRV;
+	ShaderResourceView pagedByteAddressSRV;
+	ShaderResourceView traceTypedSRV;
+	ShaderResourceView traceByteAddressSRV;
+	ShaderResourceView traceStructuredSRV;
+
+	const ShaderResourceView& structAosSRV(unsigned structBytes) const
+	{
+		switch (structBytes)
+		{
+		case 32: return structSRV_32;
+		case 64: return structSRV_64;
+		case 128: return structSRV_128;
+		default: return structSRV_256;
+		}
+	}
+
+	ComPtr<ID3D12Resource> texR8;
+	ComPtr<ID3D12Resource> texR16F;
+	ComPtr<ID3D12Resource> texR32F;
+	ComPtr<ID3D12Resource> texRG8;
+	ComPtr<ID3D12Resource> texRG16F;
+	ComPtr<ID3D12Resource> texRG32F;
+	ComPtr<ID3D12Resource> texRGBA8;
+	ComPtr<ID3D12Resource> texRGBA16F;
+	ComPtr<ID3D12Resource> texRGBA32F;
+	ComPtr<ID3D12Resource> texTrace;		// Null without -trace, TRACE_TEXTURE_WIDTH texels per row
+
+	ShaderResourceView texSRV_R8;
+	ShaderResourceView texSRV_R16F;
+	ShaderResourceView texSRV_R32F;
+	ShaderResourceView texSRV_RG8;
+	ShaderResourceView texSRV_RG16F;
+	ShaderResourceView texSRV_RG32F;
+	ShaderResourceView texSRV_RGBA8;
+	ShaderResourceView texSRV_RGBA16F;
+	ShaderResourceView texSRV_RGBA32F;
+	ShaderResourceView traceTexSRV;
+
+	ComPtr<ID3D12Resource> loadCB;
+	ComPtr<ID3D12Resource> loadCBUnaligned;
+	ComPtr<ID3D12Resource> loadWithArrayCB;
+
+	// Null if bindless isn't supported
+	ComPtr<ID3D12Resource> bindlessTypedCB;
+	ComPtr<ID3D12Resource> bindlessByteAddressCB;
+	ComPtr<ID3D12Resource> bindlessStructuredCB;
+	ComPtr<ID3D12Resource> bindlessTexCB;
+	ComPtr<ID3D12Resource> pagedCB;			// Null without -workingset
+	std::vector<ComPtr<ID3D12Resource>> divergenceCBs;		// patternWays 1, 2, 4 ... MAX_PATTERN_WAYS
+	std::vector<std::pair<unsigned, ComPtr<ID3D12Resource>>> aluCBs;	// aluOps 0, 1, 4 ... MAX_ALU_OPS
+};
 
 int main(int argc, char *argv[])
 {
 	// Enumerate adapters
 	std::vector<ComPtr<IDXGIAdapter>> adapters = enumerateAdapters();
-	printf("PerfTest\nTo select adapter, use: PerfTest.exe [ADAPTER_INDEX]\n\n");
+	printf("PerfTest\nTo select adapter, use: PerfTest.exe [ADAPTER_INDEX] [OPTIONS]\n");
+	printf("Options:\n");
+	printf("  -batch K    Split each test case into K (2-1024) back-to-back dispatches, with and without UAV barriers\n");
+	printf("  -repeat R   Repeat each test case R times between its timestamps to amortize fixed overheads\n");
+	printf("  -clock MHz  Shader clock of the adapter, for loads/clock/CU\n");
+	printf("  -cus N      Compute unit (SM/Xe core) count of the adapter, for loads/clock/CU\n");
+	printf("  -pipelinestats  Collect pipeline statistics (CS invocations) for every test case\n");
+	printf("  -verify     Disassemble every kernel and check that its loads survived compilation\n");
+	printf("  -validate   Check the kernel outputs against a CPU reference\n");
+	printf("  -content C  Input contents: zero, constant, random, gradient, pattern or file:PATH. Repeat to run the suite per content\n");
+	printf("  -placement P  Input memory: committed, placed4k, placed64k, placed2m, aliased (buffers only), upload or readback. Repeat to run the suite per placement\n");
+	printf("  -workingset MB  Add paged load test cases over an MB (1-1024) buffer, with the lanes of a load in different pages\n");
+	printf("  -transfer   Run the upload/readback transfer benchmarks after the load benchmarks\n");
+	printf("  -async N    Run load kernels concurrently on the direct queue, N async compute queues and a copy queue\n");
+	printf("  -trace PATH  Replay an address trace file through the trace kernels\n");
+	printf("  -wavetiming [PATH]  Record the start/end event order of every wave of the instrumented kernels, PATH writes the records as CSV\n");
+	printf("  -timeline PATH  Write a CPU and GPU timeline of the run as Chrome trace event JSON\n");
+	printf("  -results PATH  Export the results as CSV\n");
+	printf("  -report OUT FILES...  Write a Markdown (or .html) report of exported result files and exit\n");
+	printf("  -history PATH  Append the results to a history file\n");
+	printf("  -historyquery PATH [FILTER]  Print the trends and change points of a history file and exit\n");
+	printf("  -soak MINUTES [PATH]  Cycle the suite for MINUTES and report cold vs steady state times\n\n");
 	printf("Adapters found:\n");
 	int index = 0;
 	for (auto&& adapter : adapters)
@@ -58,19 +947,67 @@ int main(int argc, char *argv[])
 	}
 
 	// Command line index can be used to select adapter
-	int selectedAdapterIdx = 0;
-	if (argc == 2)
+	std::optional<CommandLineOptions> parsedOptions = parseCommandLine(argc, argv);
+	if (!parsedOptions)
+		return 1;
+	CommandLineOptions options = *parsedOptions;
+
+	// Report mode doesn't need the device
+	if (!options.reportFile.empty())
 	{
-		selectedAdapterIdx = std::stoi(argv[1]);
-		selectedAdapterIdx = min(max(0, selectedAdapterIdx), (int)adapters.size() - 1);
+		std::vector<ResultFile> runs;
+		for (const std::string& input : options.reportInputs)
+		{
+			std::optional<ResultFile> run = loadResults(input);
+			if (!run)
+				return 1;
+			runs.push_back(std::move(*run));
+		}
+		if (runs.empty() || !writeReport(options.reportFile, runs))
+		{
+			printf("Can't write the report to %s\n", options.reportFile.c_str());
+			return 1;
+		}
+		printf("Report of %u result files written to %s\n", (unsigned)runs.size(), options.reportFile.c_str());
+		return 0;
 	}
+
+	if (!options.historyQueryFile.empty())
+	{
+		std::optional<std::vector<HistoryEntry>> history = loadHistory(options.historyQueryFile);
+		if (!history)
+			return 1;
+		printHistory(*history, options.historyFilter);
+		return 0;
+	}
+
+	int selectedAdapterIdx = min(max(0, options.adapterIndex), (int)adapters.size() - 1);
 	printf("Using adapter %d\n", selectedAdapterIdx);
+	DXGI_ADAPTER_DESC selectedAdapterDesc;
+	adapters[selectedAdapterIdx]->GetDesc(&selectedAdapterDesc);
+	char adapterName[128];
+	snprintf(adapterName, sizeof(adapterName), "%S", selectedAdapterDesc.Description);
+
+	// User mode driver version, for the results history
+	char driverVersion[64] = "unknown";
+	LARGE_INTEGER umdVersion;
+	if (SUCCEEDED(adapters[selectedAdapterIdx]->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion)))
+	{
+		snprintf(driverVersion, sizeof(driverVersion), "%u.%u.%u.%u", HIWORD(umdVersion.HighPart), LOWORD(umdVersion.HighPart),
+			HIWORD(umdVersion.LowPart), LOWORD(umdVersion.LowPart));
+	}
 
 	// Init systems
 	uint2 resolution(256, 256);
 	HWND window = createWindow(resolution);
 	DirectXDevice dx(window, resolution, adapters[selectedAdapterIdx].Get());
 
+	if (options.pipelineStatistics && !dx.enablePipelineStatistics())
+	{
+		printf("Pipeline statistics queries are not supported. Collecting timestamps only.\n");
+		options.pipelineStatistics = false;
+	}
+
 	// Load shaders 
 	printf("Loading shaders...");
 	ComputePSO shaderLoadTyped1dInvariant = loadComputeShader(dx, "shaders/loadTyped1dInvariant.cso");
@@ -82,6 +1019,7 @@ int main(int argc, char *argv[])
 	ComputePSO shaderLoadTyped4dInvariant = loadComputeShader(dx, "shaders/loadTyped4dInvariant.cso");
 	ComputePSO shaderLoadTyped4dLinear = loadComputeShader(dx, "shaders/loadTyped4dLinear.cso");
 	ComputePSO shaderLoadTyped4dRandom = loadComputeShader(dx, "shaders/loadTyped4dRandom.cso");
+	ComputePSO shaderLoadTyped4dPaged = loadComputeShader(dx, "shaders/loadTyped4dPaged.cso");
 
 	ComputePSO shaderLoadRaw1dInvariant = loadComputeShader(dx, "shaders/loadRaw1dInvariant.cso");
 	ComputePSO shaderLoadRaw1dLinear = loadComputeShader(dx, "shaders/loadRaw1dLinear.cso");
@@ -95,6 +1033,7 @@ int main(int argc, char *argv[])
 	ComputePSO shaderLoadRaw4dInvariant = loadComputeShader(dx, "shaders/loadRaw4dInvariant.cso");
 	ComputePSO shaderLoadRaw4dLinear = loadComputeShader(dx, "shaders/loadRaw4dLinear.cso");
 	ComputePSO shaderLoadRaw4dRandom = loadComputeShader(dx, "shaders/loadRaw4dRandom.cso");
+	ComputePSO shaderLoadRaw4dPaged = loadComputeShader(dx, "shaders/loadRaw4dPaged.cso");
 
 	ComputePSO shaderLoadTex1dInvariant = loadComputeShader(dx, "shaders/loadTex1dInvariant.cso");
 	ComputePSO shaderLoadTex1dLinear = loadComputeShader(dx, "shaders/loadTex1dLinear.cso");
@@ -129,267 +1068,786 @@ int main(int argc, char *argv[])
 	ComputePSO shaderLoadStructured4dInvariant = loadComputeShader(dx, "shaders/loadStructured4dInvariant.cso");
 	ComputePSO shaderLoadStructured4dLinear = loadComputeShader(dx, "shaders/loadStructured4dLinear.cso");
 	ComputePSO shaderLoadStructured4dRandom = loadComputeShader(dx, "shaders/loadStructured4dRandom.cso");
+
+	ComputePSO shaderEmpty = loadComputeShader(dx, "shaders/empty.cso");
+
+	// Shader model 6.x kernels are skipped when compiled with compile_shaders_5_1.bat
+	auto kernelsCompiled = [](const std::vector<std::string>& kernels)
+	{
+		return std::all_of(kernels.begin(), kernels.end(), [](const std::string& kernel) { return isShaderCompiled("shaders/" + kernel + ".cso"); });
+	};
+
+	// Shader model 6.6 descriptor heap indexing, the same kernels as loadXXX4dLinear/Random
+	std::vector<std::string> bindlessKernels;
+	for (const char* resource : { "loadTyped", "loadRaw", "loadStructured", "loadTex" })
+	{
+		for (const char* pattern : { "Linear", "Random" })
+		{
+			for (const char* binding : { "Bindless", "BindlessWave", "BindlessNonUniform" })
+				bindlessKernels.push_back(std::string(resource) + "4d" + pattern + binding);
+		}
+	}
+	bool bindlessCompiled = kernelsCompiled(bindlessKernels);
+	bool bindless = dx.supportsBindless() && bindlessCompiled;
+	std::map<std::string, ComputePSO> bindlessShaders;
+	if (bindless)
+	{
+		for (const std::string& kernel : bindlessKernels)
+			bindlessShaders.emplace(kernel, loadComputeShader(dx, "shaders/" + kernel + ".cso"));
+	}
+
+	// Root signature variants: CBV and SRV as root descriptors, or the constants as root constants
+	std::map<std::string, ComputePSO> rootBindingShaders;
+	for (const char* pattern : { "Invariant", "Linear", "Random" })
+	{
+		for (std::string resource : { "loadRaw", "loadStructured" })
+			rootBindingShaders.emplace(resource + "4d" + pattern + "RootDescriptor", loadComputeShader(dx, "shaders/" + resource + "4d" + pattern + "RootDescriptor.cso"));
+		for (std::string resource : { "loadTyped", "loadRaw", "loadStructured", "loadTex" })
+			rootBindingShaders.emplace(resource + "4d" + pattern + "RootConstants", loadComputeShader(dx, "shaders/" + resource + "4d" + pattern + "RootConstants.cso"));
+	}
+
+	// Native 16-bit and 64-bit type kernels, shader model 6.2
+	std::vector<std::string> native16BitKernels;
+	std::vector<std::string> int64Kernels;
+	for (const char* pattern : { "Invariant", "Linear", "Random" })
+	{
+		for (std::string kernel : { "loadRaw1dF16", "loadRaw2dF16", "loadRaw4dF16", "loadRaw4dU16", "loadStructured1dF16", "loadStructured2dF16", "loadStructured4dF16", "loadStructured4dU16" })
+			native16BitKernels.push_back(kernel + pattern);
+		for (std::string kernel : { "loadRaw1dU64", "loadRaw2dU64" })
+			int64Kernels.push_back(kernel + pattern);
+	}
+	bool native16BitCompiled = kernelsCompiled(native16BitKernels);
+	bool int64Compiled = kernelsCompiled(int64Kernels);
+	bool native16BitTypes = dx.supports16BitTypes() && native16BitCompiled;
+	bool int64 = dx.supportsInt64() && int64Compiled;
+	std::map<std::string, ComputePSO> nativeTypeShaders;
+	if (native16BitTypes)
+	{
+		for (const std::string& kernel : native16BitKernels)
+			nativeTypeShaders.emplace(kernel, loadComputeShader(dx, "shaders/" + kernel + ".cso"));
+	}
+	if (int64)
+	{
+		for (const std::string& kernel : int64Kernels)
+			nativeTypeShaders.emplace(kernel, loadComputeShader(dx, "shaders/" + kernel + ".cso"));
+	}
+
+	// Extended access pattern kernels, 4d loads
+	std::map<std::string, ComputePSO> patternShaders;
+	for (const char* pattern : { "Strided", "Morton", "Divergent", "Clustered", "Indexed" })
+	{
+		for (std::string resource : { "loadTyped", "loadRaw", "loadStructured", "loadConstant", "loadTex", "sampleTex" })
+			patternShaders.emplace(resource + "4d" + pattern, loadComputeShader(dx, "shaders/" + resource + "4d" + pattern + ".cso"));
+	}
+
+	// Struct layout kernels: SoA with 1-16 fields, AoS structs of 32-256 bytes reading one, two or all fields
+	const unsigned structBytesList[] = { 32, 64, 128, 256 };
+	auto structFieldsRead = [](unsigned structBytes)
+	{
+		std::vector<unsigned> fields = { 1, 2 };
+		if (structBytes / 16 > 2)
+			fields.push_back(structBytes / 16);
+		return fields;
+	};
+	std::map<std::string, ComputePSO> structLayoutShaders;
+	for (const char* pattern : { "Linear", "Random" })
+	{
+		for (unsigned fields : { 1, 2, 4, 8, 16 })
+		{
+			std::string kernel = "loadStructSoa" + std::to_string(fields) + "f" + pattern;
+			structLayoutShaders.emplace(kernel, loadComputeShader(dx, "shaders/" + kernel + ".cso"));
+		}
+		for (unsigned structBytes : structBytesList)
+		{
+			for (unsigned fields : structFieldsRead(structBytes))
+			{
+				for (std::string resource : { "loadStructAos", "loadStructAosRaw" })
+				{
+					std::string kernel = resource + std::to_string(structBytes) + "b" + std::to_string(fields) + "f" + pattern;
+					structLayoutShaders.emplace(kernel, loadComputeShader(dx, "shaders/" + kernel + ".cso"));
+				}
+			}
+		}
+	}
+
+	// Latency hiding kernels: runtime ALU ops per load, optionally with extra groupshared memory, 4d linear loads
+	const unsigned occupancyLdsKB[] = { 0, 8, 16, 24 };
+	std::map<std::string, ComputePSO> latencyShaders;
+	for (std::string resource : { "loadTyped", "loadRaw", "loadStructured", "loadTex" })
+	{
+		for (unsigned lds : occupancyLdsKB)
+		{
+			std::string kernel = resource + "4dLinearAlu" + (lds ? "Lds" + std::to_string(lds) + "k" : "");
+			latencyShaders.emplace(kernel, loadComputeShader(dx, "shaders/" + kernel + ".cso"));
+		}
+	}
+
+	// Address trace replay kernels, 4d loads
+	std::map<std::string, ComputePSO> traceShaders;
+	for (const char* kernel : { "loadTyped4dTrace", "loadRaw4dTrace", "loadStructured4dTrace", "loadTex4dTrace" })
+		traceShaders.emplace(kernel, loadComputeShader(dx, std::string("shaders/") + kernel + ".cso"));
+
+	// Wave timing instrumented kernels, 4d loads. Only loaded for -wavetiming, they need wave intrinsics (SM 6.0).
+	std::vector<std::string> timedKernels;
+	for (std::string resource : { "loadTyped", "loadRaw", "loadStructured" })
+	{
+		for (const char* pattern : { "Linear", "Random" })
+			timedKernels.push_back(resource + "4d" + pattern + "Timed");
+	}
+	bool timedCompiled = kernelsCompiled(timedKernels);
+	std::map<std::string, ComputePSO> timedShaders;
+	if (options.waveTiming && timedCompiled)
+	{
+		for (const std::string& kernel : timedKernels)
+			timedShaders.emplace(kernel, loadComputeShader(dx, "shaders/" + kernel + ".cso"));
+	}
 	printf(" Done\n");
-	// Create buffers and output UAV
+	if (!native16BitCompiled)
+		printf("Native 16-bit type kernels not compiled (compile_shaders_6_0.bat). Skipping the float16_t and uint16_t test cases.\n");
+	else if (!native16BitTypes)
+		printf("Native 16-bit shader types not supported. Skipping the float16_t and uint16_t test cases.\n");
+	if (!int64Compiled)
+		printf("64-bit integer kernels not compiled (compile_shaders_6_0.bat). Skipping the uint64_t test cases.\n");
+	else if (!int64)
+		printf("64-bit integer shader ops not supported. Skipping the uint64_t test cases.\n");
+	if (!bindlessCompiled)
+		printf("Bindless kernels not compiled (compile_shaders_6_0.bat). Skipping the bindless test cases.\n");
+	else if (!bindless)
+		printf("Shader model 6.6 or resource binding tier 3 not supported. Skipping the bindless test cases.\n");
+	if (options.waveTiming && !timedCompiled)
+	{
+		printf("Wave timing kernels not compiled (compile_shaders_6_0.bat). Skipping the wave timing.\n");
+		options.waveTiming = false;
+	}
+	// Create output UAV
 	ComPtr<ID3D12Resource> bufferOutput = dx.createBuffer(2048, 4);
-	ComPtr<ID3D12Resource> bufferInput = dx.createBuffer(1024, 16);
-	ComPtr<ID3D12Resource> bufferInputStructured4 = dx.createBuffer(1024, 4);
-	ComPtr<ID3D12Resource> bufferInputStructured8 = dx.createBuffer(1024, 8);
-	ComPtr<ID3D12Resource> bufferInputStructured16 = dx.createBuffer(1024, 16);
 	UnorderedAccessView outputUAV = dx.createTypedUAV(bufferOutput.Get(), 2048, DXGI_FORMAT_R32_FLOAT);
 
-	// SRVs for benchmarking different buffer view formats/types
-	ShaderResourceView typedSRV_R8 = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R8_UNORM);
-	ShaderResourceView typedSRV_R16F = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R16_FLOAT);
-	ShaderResourceView typedSRV_R32F = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R32_FLOAT);
-	ShaderResourceView typedSRV_RG8 = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R8G8_UNORM);
-	ShaderResourceView typedSRV_RG16F = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R16G16_FLOAT);
-	ShaderResourceView typedSRV_RG32F = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R32G32_FLOAT);
-	ShaderResourceView typedSRV_RGBA8 = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R8G8B8A8_UNORM);
-	ShaderResourceView typedSRV_RGBA16F = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R16G16B16A16_FLOAT);
-	ShaderResourceView typedSRV_RGBA32F = dx.createTypedSRV(bufferInput.Get(), 1024, DXGI_FORMAT_R32G32B32A32_FLOAT);
-	ShaderResourceView structuredSRV_R32F = dx.createStructuredSRV(bufferInputStructured4.Get(), 1024, 4);
-	ShaderResourceView structuredSRV_RG32F = dx.createStructuredSRV(bufferInputStructured8.Get(), 1024, 8);
-	ShaderResourceView structuredSRV_RGBA32F = dx.createStructuredSRV(bufferInputStructured16.Get(), 1024, 16);
-	ShaderResourceView byteAddressSRV = dx.createByteAddressSRV(bufferInput.Get(), 1024);
-
-	// Create input textures
-	ComPtr<ID3D12Resource> texR8 = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R8_UNORM, 1);
-	ComPtr<ID3D12Resource> texR16F = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R16_FLOAT, 1);
-	ComPtr<ID3D12Resource> texR32F = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R32_FLOAT, 1);
-	ComPtr<ID3D12Resource> texRG8 = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R8G8_UNORM, 1);
-	ComPtr<ID3D12Resource> texRG16F = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R16G16_FLOAT, 1);
-	ComPtr<ID3D12Resource> texRG32F = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R32G32_FLOAT, 1);
-	ComPtr<ID3D12Resource> texRGBA8 = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R8G8B8A8_UNORM, 1);
-	ComPtr<ID3D12Resource> texRGBA16F = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R16G16B16A16_FLOAT, 1);
-	ComPtr<ID3D12Resource> texRGBA32F = dx.createTexture2d(uint2(32, 32), DXGI_FORMAT_R32G32B32A32_FLOAT, 1);
-	
-	// Texture SRVs
-	ShaderResourceView texSRV_R8 = dx.createSRV(texR8.Get());
-	ShaderResourceView texSRV_R16F = dx.createSRV(texR16F.Get());
-	ShaderResourceView texSRV_R32F = dx.createSRV(texR32F.Get());
-	ShaderResourceView texSRV_RG8 = dx.createSRV(texRG8.Get());
-	ShaderResourceView texSRV_RG16F = dx.createSRV(texRG16F.Get());
-	ShaderResourceView texSRV_RG32F = dx.createSRV(texRG32F.Get());
-	ShaderResourceView texSRV_RGBA8 = dx.createSRV(texRGBA8.Get());
-	ShaderResourceView texSRV_RGBA16F = dx.createSRV(texRGBA16F.Get());
-	ShaderResourceView texSRV_RGBA32F = dx.createSRV(texRGBA32F.Get());
-
 	// Samplers
 	SamplerState samplerNearest = dx.createSampler(DirectXDevice::SamplerType::Nearest);
 	SamplerState samplerBilinear = dx.createSampler(DirectXDevice::SamplerType::Bilinear);
 	SamplerState samplerTrilinear = dx.createSampler(DirectXDevice::SamplerType::Trilinear);
 
-	// Setup the constant buffer
-	LoadConstants loadConstants;
-	ComPtr<ID3D12Resource> loadCB = dx.createConstantBuffer(sizeof(LoadConstants));
-	ComPtr<ID3D12Resource> loadCBUnaligned = dx.createConstantBuffer(sizeof(LoadConstants));
-	loadConstants.elementsMask = 0;				// Dummy mask to prevent unwanted compiler optimizations
-	loadConstants.writeIndex = 0xffffffff;		// Never write
-	loadConstants.readStartAddress = 0;			// Aligned
-	dx.updateConstantBuffer(loadCB.Get(), loadConstants);
-	loadConstants.readStartAddress = 4;			// Unaligned
-	dx.updateConstantBuffer(loadCBUnaligned.Get(), loadConstants);
-	
-	// Setup constant buffer with float4 array for constant buffer load benchmarking
-	LoadConstantsWithArray loadConstantsWithArray;
-	ComPtr<ID3D12Resource> loadWithArrayCB = dx.createConstantBuffer(sizeof(LoadConstantsWithArray));
-	loadConstantsWithArray.elementsMask = 0;				// Dummy mask to prevent unwanted compiler optimizations
-	loadConstantsWithArray.writeIndex = 0xffffffff;			// Never write
-	loadConstantsWithArray.readStartAddress = 0;			// Aligned
-	memset(loadConstantsWithArray.benchmarkArray, 0, sizeof(loadConstantsWithArray.benchmarkArray));
-	dx.updateConstantBuffer(loadWithArrayCB.Get(), loadConstantsWithArray);
+	// The reference needs known input contents
+	if (options.inputContents.empty())
+		options.inputContents.push_back({ .content = options.validate ? InputContent::Pattern : InputContent::Undefined });
+
+	// Index buffer of the indexed pattern kernels: a shuffled start element for every thread of a group
+	std::vector<uint32_t> gatherIndices(GATHER_INDEX_COUNT);
+	std::iota(gatherIndices.begin(), gatherIndices.end(), 0);
+	std::shuffle(gatherIndices.begin(), gatherIndices.end(), std::mt19937(1));
+	ComPtr<ID3D12Resource> bufferGatherIndices = dx.createBuffer(GATHER_INDEX_COUNT, 4);
+	dx.uploadBuffer(bufferGatherIndices.Get(), gatherIndices.data(), GATHER_INDEX_COUNT * 4);
+	ShaderResourceView gatherIndicesSRV = dx.createTypedSRV(bufferGatherIndices.Get(), GATHER_INDEX_COUNT, DXGI_FORMAT_R32_UINT);
+
+	// Address trace replay: the traced element indices in load major order, and the trace dimensions
+	std::optional<AddressTrace> trace;
+	if (!options.traceFile.empty())
+	{
+		trace = loadAddressTrace(options.traceFile);
+		if (!trace)
+			printf("Skipping the address trace test cases.\n");
+	}
+	unsigned traceIndexCount = trace ? (unsigned)trace->indices.size() : 0;
+	ComPtr<ID3D12Resource> bufferTraceIndices = trace ? dx.createBuffer(traceIndexCount, 4) : nullptr;
+	ShaderResourceView traceIndicesSRV = trace ? dx.createTypedSRV(bufferTraceIndices.Get(), traceIndexCount, DXGI_FORMAT_R32_UINT) : ShaderResourceView();
+	ComPtr<ID3D12Resource> traceCB = trace ? dx.createConstantBuffer(sizeof(LoadConstants)) : nullptr;
+	LoadConstants traceConstants = {
+		.elementsMask = 0,
+		.writeIndex = 0xffffffff,
+		.patternWays = PATTERN_WAYS,
+		.traceThreads = trace ? trace->threadCount : 0,
+		.traceLoads = trace ? trace->loadsPerThread : 0,
+		.aluScale = 1.0f };
+	if (trace)
+	{
+		dx.uploadBuffer(bufferTraceIndices.Get(), trace->indices.data(), traceIndexCount * 4);
+		dx.updateConstantBuffer(traceCB.Get(), traceConstants);
+	}
+
+	std::unique_ptr<Validator> validator;
+	if (options.validate)
+	{
+		validator = std::make_unique<Validator>(dx, outputUAV, gatherIndicesSRV, traceIndicesSRV);
+		validator->setSourceData(bufferGatherIndices.Get(), std::vector<unsigned char>((unsigned char*)gatherIndices.data(), (unsigned char*)(gatherIndices.data() + GATHER_INDEX_COUNT)));
+		if (trace)
+		{
+			validator->setSourceData(bufferTraceIndices.Get(), std::vector<unsigned char>((unsigned char*)trace->indices.data(), (unsigned char*)(trace->indices.data() + traceIndexCount)));
+			validator->setConstants(traceCB.Get(), &traceConstants, sizeof(traceConstants));
+		}
+	}
+
+	// The wave records need wave intrinsics
+	std::unique_ptr<WaveTimer> waveTimer;
+	if (options.waveTiming)
+	{
+		if (dx.getWaveLaneCount() != 0)
+			waveTimer = std::make_unique<WaveTimer>(dx, outputUAV);
+		else
+			printf("Wave operations not supported. Skipping the wave timing.\n");
+	}
+
+	if (options.placements.empty())
+		options.placements.push_back({ .placement = MemoryPlacement::Committed });
+
+	// One set of input resources per input content and memory placement
+	std::vector<std::unique_ptr<InputResources>> inputs;
+	for (const InputContentDesc& content : options.inputContents)
+	{
+		for (const PlacementDesc& placement : options.placements)
+		{
+			std::vector<std::string> suffixes;
+			if (options.inputContents.size() > 1)
+				suffixes.push_back(getInputContentName(content));
+			if (options.placements.size() > 1)
+				suffixes.push_back(getPlacementName(placement));
+
+			std::string nameSuffix;
+			for (const std::string& suffix : suffixes)
+				nameSuffix += (nameSuffix.empty() ? " [" : ", ") + suffix;
+			if (!nameSuffix.empty())
+				nameSuffix += "]";
+
+			inputs.push_back(std::make_unique<InputResources>(dx, content, placement, options.workingSetMB * 1024 * 1024, trace ? trace->elementCount : 0, validator.get(), nameSuffix, bindless));
+		}
+	}
 
 	const unsigned numWarmUpFramesBeforeBenchmark = 30;
 	const unsigned numBenchmarkFrames = 30;
-	const unsigned maxTestCases = 200;
+	const unsigned maxTestCases = DirectXDevice::maxQueriesPerFrame;
 
-	printf("\nRunning %d warm-up frames and %d benchmark frames:\n", numWarmUpFramesBeforeBenchmark, numBenchmarkFrames);
+	// Soak mode replaces the fixed benchmark frame count with a duration, one X per window
+	const double soakWindowSeconds = 10.0;
+	std::unique_ptr<SoakRecorder> soak;
+	if (options.soakMinutes > 0.0f)
+	{
+		soak = std::make_unique<SoakRecorder>(dx, options.soakMinutes * 60.0, soakWindowSeconds);
+		printf("\nRunning %d warm-up frames and %.1f minutes of benchmark frames:\n", numWarmUpFramesBeforeBenchmark, options.soakMinutes);
+	}
+	else
+		printf("\nRunning %d warm-up frames and %d benchmark frames:\n", numWarmUpFramesBeforeBenchmark, numBenchmarkFrames);
 
 	struct TestCaseTiming
 	{
 		std::string name;
-		float totalTime = 0.0f;
-		std::vector<float> timings;
+		// Running sums instead of every timing, a soak collects millions of them. Doubles: a float total stops
+		// growing once a timing is below its rounding step. Mean and squared deviations are Welford's.
+		double totalTime = 0.0;
+		unsigned count = 0;
+		double mean = 0.0;
+		double squaredDeviations = 0.0;
+		uint64_t csInvocations = 0;
+		bool invocationMismatch = false;
+	};
+
+	std::vector<TestCaseTiming> timingResults(maxTestCases);
+
+	// Verifier disassembles the kernels with dxcompiler.dll
+	std::unique_ptr<ShaderVerifier> verifier;
+	if (options.verifyShaders)
+	{
+		verifier = std::make_unique<ShaderVerifier>();
+		if (!verifier->isAvailable())
+			printf("dxcompiler.dll not found. Shaders can't be verified.\n");
+	}
+
+	BenchTest bench(dx, outputUAV, gatherIndicesSRV, traceIndicesSRV, options, verifier.get(), validator.get());
+	if (options.asyncComputeQueues)
+		bench.addQueues(options.asyncComputeQueues);
+
+	// Results are read back asynchronously, a few frames after they were recorded
+	auto collectResults = [&](const PerformanceResult& result)
+	{
+		if (result.frame >= numWarmUpFramesBeforeBenchmark)
+		{
+			TestCaseTiming& row = timingResults[result.id];
+			if (row.name == "")
+			{
+				row = { result.name, 0 };
+			}
+			row.totalTime += result.timeMillis;
+			row.count++;
+			double delta = result.timeMillis - row.mean;
+			row.mean += delta / row.count;
+			row.squaredDeviations += delta * (result.timeMillis - row.mean);
+
+			if (soak && !bench.getTestCases()[result.id].calibration)
+				soak->addResult(result.frame, result.id, result.name, result.timeMillis);
+
+			// Every thread of every dispatch must have run. Catches dispatches dropped by the driver.
+			if (result.pipelineStatistics)
+			{
+				const TestCaseInfo& info = bench.getTestCases()[result.id];
+				uint64_t expectedInvocations = info.threadsPerRepetition * info.repeatCount;
+				row.csInvocations = result.pipelineStatistics->CSInvocations;
+				row.invocationMismatch |= row.csInvocations != expectedInvocations;
+			}
+		}
+	};
+
+	const std::pair<const char*, const char*> patternNames[] = { { "Invariant", "uniform" }, { "Linear", "linear" }, { "Random", "random" } };
+	// Divergence sweep up to one address per lane
+	unsigned waveLaneCount = dx.getWaveLaneCount();
+	unsigned divergenceSweepWays = waveLaneCount ? min(waveLaneCount, (unsigned)MAX_PATTERN_WAYS) : MAX_PATTERN_WAYS;
+
+	const std::pair<const char*, const char*> extendedPatternNames[] = {
+		{ "Strided", "strided" }, { "Morton", "morton" }, { "Divergent", "divergent" }, { "Clustered", "clustered" }, { "Indexed", "indexed" } };
+
+	// Test suite. Recorded once per input content every frame.
+	auto recordTestCases = [&](const InputResources& in)
+	{
+		bench.testCase(shaderLoadTyped1dInvariant, in.loadCB.Get(), in.typedSRV_R8, "Buffer<R8>.Load uniform");
+		bench.testCase(shaderLoadTyped1dLinear, in.loadCB.Get(), in.typedSRV_R8, "Buffer<R8>.Load linear");
+		bench.testCase(shaderLoadTyped1dRandom, in.loadCB.Get(), in.typedSRV_R8, "Buffer<R8>.Load random");
+		bench.testCase(shaderLoadTyped2dInvariant, in.loadCB.Get(), in.typedSRV_RG8, "Buffer<RG8>.Load uniform");
+		bench.testCase(shaderLoadTyped2dLinear, in.loadCB.Get(), in.typedSRV_RG8, "Buffer<RG8>.Load linear");
+		bench.testCase(shaderLoadTyped2dRandom, in.loadCB.Get(), in.typedSRV_RG8, "Buffer<RG8>.Load random");
+		bench.testCase(shaderLoadTyped4dInvariant, in.loadCB.Get(), in.typedSRV_RGBA8, "Buffer<RGBA8>.Load uniform");
+		bench.testCase(shaderLoadTyped4dLinear, in.loadCB.Get(), in.typedSRV_RGBA8, "Buffer<RGBA8>.Load linear");
+		bench.testCase(shaderLoadTyped4dRandom, in.loadCB.Get(), in.typedSRV_RGBA8, "Buffer<RGBA8>.Load random");
+
+		bench.testCase(shaderLoadTyped1dInvariant, in.loadCB.Get(), in.typedSRV_R16F, "Buffer<R16f>.Load uniform");
+		bench.testCase(shaderLoadTyped1dLinear, in.loadCB.Get(), in.typedSRV_R16F, "Buffer<R16f>.Load linear");
+		bench.testCase(shaderLoadTyped1dRandom, in.loadCB.Get(), in.typedSRV_R16F, "Buffer<R16f>.Load random");
+		bench.testCase(shaderLoadTyped2dInvariant, in.loadCB.Get(), in.typedSRV_RG16F, "Buffer<RG16f>.Load uniform");
+		bench.testCase(shaderLoadTyped2dLinear, in.loadCB.Get(), in.typedSRV_RG16F, "Buffer<RG16f>.Load linear");
+		bench.testCase(shaderLoadTyped2dRandom, in.loadCB.Get(), in.typedSRV_RG16F, "Buffer<RG16f>.Load random");
+		bench.testCase(shaderLoadTyped4dInvariant, in.loadCB.Get(), in.typedSRV_RGBA16F, "Buffer<RGBA16f>.Load uniform");
+		bench.testCase(shaderLoadTyped4dLinear, in.loadCB.Get(), in.typedSRV_RGBA16F, "Buffer<RGBA16f>.Load linear");
+		bench.testCase(shaderLoadTyped4dRandom, in.loadCB.Get(), in.typedSRV_RGBA16F, "Buffer<RGBA16f>.Load random");
+
+		bench.testCase(shaderLoadTyped1dInvariant, in.loadCB.Get(), in.typedSRV_R32F, "Buffer<R32f>.Load uniform");
+		bench.testCase(shaderLoadTyped1dLinear, in.loadCB.Get(), in.typedSRV_R32F, "Buffer<R32f>.Load linear");
+		bench.testCase(shaderLoadTyped1dRandom, in.loadCB.Get(), in.typedSRV_R32F, "Buffer<R32f>.Load random");
+		bench.testCase(shaderLoadTyped2dInvariant, in.loadCB.Get(), in.typedSRV_RG32F, "Buffer<RG32f>.Load uniform");
+		bench.testCase(shaderLoadTyped2dLinear, in.loadCB.Get(), in.typedSRV_RG32F, "Buffer<RG32f>.Load linear");
+		bench.testCase(shaderLoadTyped2dRandom, in.loadCB.Get(), in.typedSRV_RG32F, "Buffer<RG32f>.Load random");
+		bench.testCase(shaderLoadTyped4dInvariant, in.loadCB.Get(), in.typedSRV_RGBA32F, "Buffer<RGBA32f>.Load uniform");
+		bench.testCase(shaderLoadTyped4dLinear, in.loadCB.Get(), in.typedSRV_RGBA32F, "Buffer<RGBA32f>.Load linear");
+		bench.testCase(shaderLoadTyped4dRandom, in.loadCB.Get(), in.typedSRV_RGBA32F, "Buffer<RGBA32f>.Load random");
+
+		bench.testCase(shaderLoadRaw1dInvariant, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load uniform");
+		bench.testCase(shaderLoadRaw1dLinear, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load linear");
+		bench.testCase(shaderLoadRaw1dRandom, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load random");
+		bench.testCase(shaderLoadRaw2dInvariant, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load2 uniform");
+		bench.testCase(shaderLoadRaw2dLinear, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load2 linear");
+		bench.testCase(shaderLoadRaw2dRandom, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load2 random");
+		bench.testCase(shaderLoadRaw3dInvariant, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load3 uniform");
+		bench.testCase(shaderLoadRaw3dLinear, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load3 linear");
+		bench.testCase(shaderLoadRaw3dRandom, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load3 random");
+		bench.testCase(shaderLoadRaw4dInvariant, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load4 uniform");
+		bench.testCase(shaderLoadRaw4dLinear, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load4 linear");
+		bench.testCase(shaderLoadRaw4dRandom, in.loadCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load4 random");
+
+		bench.testCase(shaderLoadRaw2dInvariant, in.loadCBUnaligned.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load2 unaligned uniform");
+		bench.testCase(shaderLoadRaw2dLinear, in.loadCBUnaligned.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load2 unaligned linear");
+		bench.testCase(shaderLoadRaw2dRandom, in.loadCBUnaligned.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load2 unaligned random");
+		bench.testCase(shaderLoadRaw4dInvariant, in.loadCBUnaligned.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load4 unaligned uniform");
+		bench.testCase(shaderLoadRaw4dLinear, in.loadCBUnaligned.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load4 unaligned linear");
+		bench.testCase(shaderLoadRaw4dRandom, in.loadCBUnaligned.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load4 unaligned random");
+
+		// Large working set: the lanes of every load hit different pages, far beyond the TLB reach
+		if (in.bufferPaged)
+		{
+			bench.testCase(shaderLoadTyped4dPaged, in.pagedCB.Get(), in.pagedTypedSRV, "Buffer<RGBA32f>.Load paged");
+			bench.testCase(shaderLoadRaw4dPaged, in.pagedCB.Get(), in.pagedByteAddressSRV, "ByteAddressBuffer.Load4 paged");
+		}
+
+		bench.testCase(shaderLoadStructured1dInvariant, in.loadCB.Get(), in.structuredSRV_R32F, "StructuredBuffer<float>.Load uniform");
+		bench.testCase(shaderLoadStructured1dLinear, in.loadCB.Get(), in.structuredSRV_R32F, "StructuredBuffer<float>.Load linear");
+		bench.testCase(shaderLoadStructured1dRandom, in.loadCB.Get(), in.structuredSRV_R32F, "StructuredBuffer<float>.Load random");
+		bench.testCase(shaderLoadStructured2dInvariant, in.loadCB.Get(), in.structuredSRV_RG32F, "StructuredBuffer<float2>.Load uniform");
+		bench.testCase(shaderLoadStructured2dLinear, in.loadCB.Get(), in.structuredSRV_RG32F, "StructuredBuffer<float2>.Load linear");
+		bench.testCase(shaderLoadStructured2dRandom, in.loadCB.Get(), in.structuredSRV_RG32F, "StructuredBuffer<float2>.Load random");
+		bench.testCase(shaderLoadStructured4dInvariant, in.loadCB.Get(), in.structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load uniform");
+		bench.testCase(shaderLoadStructured4dLinear, in.loadCB.Get(), in.structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load linear");
+		bench.testCase(shaderLoadStructured4dRandom, in.loadCB.Get(), in.structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load random");
+
+		// Native 16-bit and 64-bit types, accumulated in the same type. Reported against the typed loads of the
+		// same width: 16-bit floats against the 16-bit float formats, 64-bit integers against the 32-bit float pairs.
+		struct NativeTypeSource
+		{
+			const char* kernel;
+			const ShaderResourceView& source;
+			const char* name;
+			const char* baselineName;
+		};
+		NativeTypeSource nativeTypeSources[] = {
+			{ "loadRaw1dF16", in.byteAddressSRV, "ByteAddressBuffer.Load<float16_t>", "Buffer<R16f>.Load" },
+			{ "loadRaw2dF16", in.byteAddressSRV, "ByteAddressBuffer.Load<float16_t2>", "Buffer<RG16f>.Load" },
+			{ "loadRaw4dF16", in.byteAddressSRV, "ByteAddressBuffer.Load<float16_t4>", "Buffer<RGBA16f>.Load" },
+			{ "loadRaw4dU16", in.byteAddressSRV, "ByteAddressBuffer.Load<uint16_t4>", "Buffer<RGBA16f>.Load" },
+			{ "loadRaw1dU64", in.byteAddressSRV, "ByteAddressBuffer.Load<uint64_t>", "Buffer<RG32f>.Load" },
+			{ "loadRaw2dU64", in.byteAddressSRV, "ByteAddressBuffer.Load<uint64_t2>", "Buffer<RGBA32f>.Load" },
+			{ "loadStructured1dF16", in.structuredSRV_16, "StructuredBuffer<float16_t>.Load", "Buffer<R16f>.Load" },
+			{ "loadStructured2dF16", in.structuredSRV_R32F, "StructuredBuffer<float16_t2>.Load", "Buffer<RG16f>.Load" },
+			{ "loadStructured4dF16", in.structuredSRV_RG32F, "StructuredBuffer<float16_t4>.Load", "Buffer<RGBA16f>.Load" },
+			{ "loadStructured4dU16", in.structuredSRV_RG32F, "StructuredBuffer<uint16_t4>.Load", "Buffer<RGBA16f>.Load" } };
+		for (const NativeTypeSource& source : nativeTypeSources)
+		{
+			for (auto [pattern, patternName] : patternNames)
+			{
+				auto shader = nativeTypeShaders.find(std::string(source.kernel) + pattern);
+				if (shader != nativeTypeShaders.end())
+				{
+					bench.comparedTestCase(shader->second, in.loadCB.Get(), source.source, std::string(source.name) + " " + patternName,
+						std::string(source.baselineName) + " " + patternName, "typed");
+				}
+			}
+		}
+
+		// Struct layouts: the same float4 fields read from SoA planes and from AoS structs. AoS is reported against
+		// SoA reading the same number of fields.
+		std::pair<const char*, const char*> structPatterns[] = { { "Linear", "linear" }, { "Random", "random" } };
+		for (auto [pattern, patternName] : structPatterns)
+		{
+			auto soaName = [&](unsigned fields)
+			{
+				return "Struct SoA: " + std::to_string(fields) + (fields == 1 ? " float4 field " : " float4 fields ") + patternName;
+			};
+			for (unsigned fields : { 1, 2, 4, 8, 16 })
+				bench.testCase(structLayoutShaders.at("loadStructSoa" + std::to_string(fields) + "f" + pattern), in.loadCB.Get(), in.structSoaSRV, soaName(fields));
+			for (unsigned structBytes : structBytesList)
+			{
+				for (unsigned fields : structFieldsRead(structBytes))
+				{
+					std::string kernel = std::to_string(structBytes) + "b" + std::to_string(fields) + "f" + pattern;
+					std::string fieldsName = std::to_string(fields) + (fields == 1 ? " float4 field " : " float4 fields ") + patternName;
+					bench.comparedTestCase(structLayoutShaders.at("loadStructAos" + kernel), in.loadCB.Get(), in.structAosSRV(structBytes),
+						"Struct AoS " + std::to_string(structBytes) + "B StructuredBuffer: " + fieldsName, soaName(fields), "SoA");
+					bench.comparedTestCase(structLayoutShaders.at("loadStructAosRaw" + kernel), in.loadCB.Get(), in.structRawSRV,
+						"Struct AoS " + std::to_string(structBytes) + "B ByteAddressBuffer: " + fieldsName, soaName(fields), "SoA");
+				}
+			}
+		}
+
+		bench.testCase(shaderLoadConstant4dInvariant, in.loadWithArrayCB.Get(), {}, "cbuffer{float4} load uniform");
+		bench.testCase(shaderLoadConstant4dLinear, in.loadWithArrayCB.Get(), {}, "cbuffer{float4} load linear");
+		bench.testCase(shaderLoadConstant4dRandom, in.loadWithArrayCB.Get(), {}, "cbuffer{float4} load random");
+
+		bench.testCase(shaderLoadTex1dInvariant, in.loadCB.Get(), in.texSRV_R8, "Texture2D<R8>.Load uniform");
+		bench.testCase(shaderLoadTex1dLinear, in.loadCB.Get(), in.texSRV_R8, "Texture2D<R8>.Load linear");
+		bench.testCase(shaderLoadTex1dRandom, in.loadCB.Get(), in.texSRV_R8, "Texture2D<R8>.Load random");
+		bench.testCase(shaderLoadTex2dInvariant, in.loadCB.Get(), in.texSRV_RG8, "Texture2D<RG8>.Load uniform");
+		bench.testCase(shaderLoadTex2dLinear, in.loadCB.Get(), in.texSRV_RG8, "Texture2D<RG8>.Load linear");
+		bench.testCase(shaderLoadTex2dRandom, in.loadCB.Get(), in.texSRV_RG8, "Texture2D<RG8>.Load random");
+		bench.testCase(shaderLoadTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA8, "Texture2D<RGBA8>.Load uniform");
+		bench.testCase(shaderLoadTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA8, "Texture2D<RGBA8>.Load linear");
+		bench.testCase(shaderLoadTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA8, "Texture2D<RGBA8>.Load random");
+
+		bench.testCase(shaderLoadTex1dInvariant, in.loadCB.Get(), in.texSRV_R16F, "Texture2D<R16F>.Load uniform");
+		bench.testCase(shaderLoadTex1dLinear, in.loadCB.Get(), in.texSRV_R16F, "Texture2D<R16F>.Load linear");
+		bench.testCase(shaderLoadTex1dRandom, in.loadCB.Get(), in.texSRV_R16F, "Texture2D<R16F>.Load random");
+		bench.testCase(shaderLoadTex2dInvariant, in.loadCB.Get(), in.texSRV_RG16F, "Texture2D<RG16F>.Load uniform");
+		bench.testCase(shaderLoadTex2dLinear, in.loadCB.Get(), in.texSRV_RG16F, "Texture2D<RG16F>.Load linear");
+		bench.testCase(shaderLoadTex2dRandom, in.loadCB.Get(), in.texSRV_RG16F, "Texture2D<RG16F>.Load random");
+		bench.testCase(shaderLoadTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA16F, "Texture2D<RGBA16F>.Load uniform");
+		bench.testCase(shaderLoadTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA16F, "Texture2D<RGBA16F>.Load linear");
+		bench.testCase(shaderLoadTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA16F, "Texture2D<RGBA16F>.Load random");
+
+		bench.testCase(shaderLoadTex1dInvariant, in.loadCB.Get(), in.texSRV_R32F, "Texture2D<R32F>.Load uniform");
+		bench.testCase(shaderLoadTex1dLinear, in.loadCB.Get(), in.texSRV_R32F, "Texture2D<R32F>.Load linear");
+		bench.testCase(shaderLoadTex1dRandom, in.loadCB.Get(), in.texSRV_R32F, "Texture2D<R32F>.Load random");
+		bench.testCase(shaderLoadTex2dInvariant, in.loadCB.Get(), in.texSRV_RG32F, "Texture2D<RG32F>.Load uniform");
+		bench.testCase(shaderLoadTex2dLinear, in.loadCB.Get(), in.texSRV_RG32F, "Texture2D<RG32F>.Load linear");
+		bench.testCase(shaderLoadTex2dRandom, in.loadCB.Get(), in.texSRV_RG32F, "Texture2D<RG32F>.Load random");
+		bench.testCase(shaderLoadTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA32F, "Texture2D<RGBA32F>.Load uniform");
+		bench.testCase(shaderLoadTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA32F, "Texture2D<RGBA32F>.Load linear");
+		bench.testCase(shaderLoadTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA32F, "Texture2D<RGBA32F>.Load random");
+
+		bench.testCaseWithSampler(shaderSampleTex1dInvariant, in.loadCB.Get(), in.texSRV_R8, samplerNearest, "Texture2D<R8>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex1dLinear, in.loadCB.Get(), in.texSRV_R8, samplerNearest, "Texture2D<R8>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex1dRandom, in.loadCB.Get(), in.texSRV_R8, samplerNearest, "Texture2D<R8>.Sample(nearest) random");
+		bench.testCaseWithSampler(shaderSampleTex2dInvariant, in.loadCB.Get(), in.texSRV_RG8, samplerNearest, "Texture2D<RG8>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex2dLinear, in.loadCB.Get(), in.texSRV_RG8, samplerNearest, "Texture2D<RG8>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex2dRandom, in.loadCB.Get(), in.texSRV_RG8, samplerNearest, "Texture2D<RG8>.Sample(nearest) random");
+		bench.testCaseWithSampler(shaderSampleTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA8, samplerNearest, "Texture2D<RGBA8>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA8, samplerNearest, "Texture2D<RGBA8>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA8, samplerNearest, "Texture2D<RGBA8>.Sample(nearest) random");
+
+		bench.testCaseWithSampler(shaderSampleTex1dInvariant, in.loadCB.Get(), in.texSRV_R16F, samplerNearest, "Texture2D<R16F>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex1dLinear, in.loadCB.Get(), in.texSRV_R16F, samplerNearest, "Texture2D<R16F>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex1dRandom, in.loadCB.Get(), in.texSRV_R16F, samplerNearest, "Texture2D<R16F>.Sample(nearest) random");
+		bench.testCaseWithSampler(shaderSampleTex2dInvariant, in.loadCB.Get(), in.texSRV_RG16F, samplerNearest, "Texture2D<RG16F>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex2dLinear, in.loadCB.Get(), in.texSRV_RG16F, samplerNearest, "Texture2D<RG16F>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex2dRandom, in.loadCB.Get(), in.texSRV_RG16F, samplerNearest, "Texture2D<RG16F>.Sample(nearest) random");
+		bench.testCaseWithSampler(shaderSampleTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA16F, samplerNearest, "Texture2D<RGBA16F>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA16F, samplerNearest, "Texture2D<RGBA16F>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA16F, samplerNearest, "Texture2D<RGBA16F>.Sample(nearest) random");
+
+		bench.testCaseWithSampler(shaderSampleTex1dInvariant, in.loadCB.Get(), in.texSRV_R32F, samplerNearest, "Texture2D<R32F>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex1dLinear, in.loadCB.Get(), in.texSRV_R32F, samplerNearest, "Texture2D<R32F>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex1dRandom, in.loadCB.Get(), in.texSRV_R32F, samplerNearest, "Texture2D<R32F>.Sample(nearest) random");
+		bench.testCaseWithSampler(shaderSampleTex2dInvariant, in.loadCB.Get(), in.texSRV_RG32F, samplerNearest, "Texture2D<RG32F>.Sample(nearest) uniform");
+		bench.testCaseWithSampler(shaderSampleTex2dLinear, in.loadCB.Get(), in.texSRV_RG32F, samplerNearest, "Texture2D<RG32F>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex2dRandom, in.loadCB.Get(), in.texSRV_RG32F, samplerNearest, "Texture2D<RG32F>.Sample(nearest) random");
+		bench.testCaseWithSampler(shaderSampleTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA32F, samplerNearest, "Texture2D<RGBA32F>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA32F, samplerNearest, "Texture2D<RGBA32F>.Sample(nearest) linear");
+		bench.testCaseWithSampler(shaderSampleTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA32F, samplerNearest, "Texture2D<RGBA32F>.Sample(nearest) random");
+
+		bench.testCaseWithSampler(shaderSampleTex1dInvariant, in.loadCB.Get(), in.texSRV_R8, samplerBilinear, "Texture2D<R8>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex1dLinear, in.loadCB.Get(), in.texSRV_R8, samplerBilinear, "Texture2D<R8>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex1dRandom, in.loadCB.Get(), in.texSRV_R8, samplerBilinear, "Texture2D<R8>.Sample(bilinear) random");
+		bench.testCaseWithSampler(shaderSampleTex2dInvariant, in.loadCB.Get(), in.texSRV_RG8, samplerBilinear, "Texture2D<RG8>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex2dLinear, in.loadCB.Get(), in.texSRV_RG8, samplerBilinear, "Texture2D<RG8>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex2dRandom, in.loadCB.Get(), in.texSRV_RG8, samplerBilinear, "Texture2D<RG8>.Sample(bilinear) random");
+		bench.testCaseWithSampler(shaderSampleTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA8, samplerBilinear, "Texture2D<RGBA8>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA8, samplerBilinear, "Texture2D<RGBA8>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA8, samplerBilinear, "Texture2D<RGBA8>.Sample(bilinear) random");
+
+		bench.testCaseWithSampler(shaderSampleTex1dInvariant, in.loadCB.Get(), in.texSRV_R16F, samplerBilinear, "Texture2D<R16F>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex1dLinear, in.loadCB.Get(), in.texSRV_R16F, samplerBilinear, "Texture2D<R16F>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex1dRandom, in.loadCB.Get(), in.texSRV_R16F, samplerBilinear, "Texture2D<R16F>.Sample(bilinear) random");
+		bench.testCaseWithSampler(shaderSampleTex2dInvariant, in.loadCB.Get(), in.texSRV_RG16F, samplerBilinear, "Texture2D<RG16F>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex2dLinear, in.loadCB.Get(), in.texSRV_RG16F, samplerBilinear, "Texture2D<RG16F>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex2dRandom, in.loadCB.Get(), in.texSRV_RG16F, samplerBilinear, "Texture2D<RG16F>.Sample(bilinear) random");
+		bench.testCaseWithSampler(shaderSampleTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA16F, samplerBilinear, "Texture2D<RGBA16F>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA16F, samplerBilinear, "Texture2D<RGBA16F>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA16F, samplerBilinear, "Texture2D<RGBA16F>.Sample(bilinear) random");
+
+		bench.testCaseWithSampler(shaderSampleTex1dInvariant, in.loadCB.Get(), in.texSRV_R32F, samplerBilinear, "Texture2D<R32F>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex1dLinear, in.loadCB.Get(), in.texSRV_R32F, samplerBilinear, "Texture2D<R32F>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex1dRandom, in.loadCB.Get(), in.texSRV_R32F, samplerBilinear, "Texture2D<R32F>.Sample(bilinear) random");
+		bench.testCaseWithSampler(shaderSampleTex2dInvariant, in.loadCB.Get(), in.texSRV_RG32F, samplerBilinear, "Texture2D<RG32F>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex2dLinear, in.loadCB.Get(), in.texSRV_RG32F, samplerBilinear, "Texture2D<RG32F>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex2dRandom, in.loadCB.Get(), in.texSRV_RG32F, samplerBilinear, "Texture2D<RG32F>.Sample(bilinear) random");
+		bench.testCaseWithSampler(shaderSampleTex4dInvariant, in.loadCB.Get(), in.texSRV_RGBA32F, samplerBilinear, "Texture2D<RGBA32F>.Sample(bilinear) uniform");
+		bench.testCaseWithSampler(shaderSampleTex4dLinear, in.loadCB.Get(), in.texSRV_RGBA32F, samplerBilinear, "Texture2D<RGBA32F>.Sample(bilinear) linear");
+		bench.testCaseWithSampler(shaderSampleTex4dRandom, in.loadCB.Get(), in.texSRV_RGBA32F, samplerBilinear, "Texture2D<RGBA32F>.Sample(bilinear) random");
+
+		// Extended access patterns (accessPattern.hlsli) between the linear and random extremes, 4d loads of every resource type.
+		// Buffers use 16 byte elements, the divergent addresses are a 128 byte cache line apart.
+		struct PatternSource
+		{
+			const char* kernel;
+			ID3D12Resource* cb;
+			const ShaderResourceView& source;
+			const SamplerState* sampler;
+			const char* name;
+		};
+		const ShaderResourceView noSource = {};
+		PatternSource patternSources[] = {
+			{ "loadTyped", in.loadCB.Get(), in.typedSRV_RGBA32F, nullptr, "Buffer<RGBA32f>.Load" },
+			{ "loadRaw", in.loadCB.Get(), in.byteAddressSRV, nullptr, "ByteAddressBuffer.Load4" },
+			{ "loadStructured", in.loadCB.Get(), in.structuredSRV_RGBA32F, nullptr, "StructuredBuffer<float4>.Load" },
+			{ "loadConstant", in.loadWithArrayCB.Get(), noSource, nullptr, "cbuffer{float4} load" },
+			{ "loadTex", in.loadCB.Get(), in.texSRV_RGBA8, nullptr, "Texture2D<RGBA8>.Load" },
+			{ "sampleTex", in.loadCB.Get(), in.texSRV_RGBA8, &samplerNearest, "Texture2D<RGBA8>.Sample(nearest)" } };
+		for (const PatternSource& source : patternSources)
+		{
+			std::string linearName = std::string(source.name) + " linear";
+			for (auto [pattern, patternName] : extendedPatternNames)
+			{
+				ComputePSO& shader = patternShaders.at(std::string(source.kernel) + "4d" + pattern);
+				bench.comparedTestCase(shader, source.cb, source.source, std::string(source.name) + " " + patternName, linearName, "linear", source.sampler);
+			}
+		}
+
+		// Divergence sweep: the divergent pattern from 1 address per wave (uniform) to one per lane. Float4
+		// elements, so every address is its own cache line (texture: its own 2x2 texel quad).
+		struct SweepSource
+		{
+			const char* kernel;
+			const ShaderResourceView& source;
+			const SamplerState* sampler;
+			const char* name;
+		};
+		SweepSource sweepSources[] = {
+			{ "loadTyped", in.typedSRV_RGBA32F, nullptr, "Buffer<RGBA32f>.Load" },
+			{ "loadStructured", in.structuredSRV_RGBA32F, nullptr, "StructuredBuffer<float4>.Load" },
+			{ "loadTex", in.texSRV_RGBA32F, nullptr, "Texture2D<RGBA32F>.Load" },
+			{ "sampleTex", in.texSRV_RGBA32F, &samplerNearest, "Texture2D<RGBA32F>.Sample(nearest)" } };
+		for (const SweepSource& source : sweepSources)
+		{
+			ComputePSO& shader = patternShaders.at(std::string(source.kernel) + "4dDivergent");
+			for (unsigned i = 0; (1u << i) <= divergenceSweepWays; i++)
+			{
+				unsigned ways = 1u << i;
+				std::string name = std::string(source.name) + " divergent " + std::to_string(ways) + (ways == 1 ? " way" : " ways");
+				bench.sweepTestCase(shader, in.divergenceCBs[i].Get(), source.source, source.sampler, name, std::string(source.name) + " divergence", ways);
+			}
+		}
+
+		// Latency hiding: dependent ALU ops after every load, at full occupancy and with extra groupshared memory
+		// limiting the groups per CU. One curve per occupancy, time relative to the kernel without ALU ops.
+		struct LatencySource
+		{
+			const char* kernel;
+			const ShaderResourceView& source;
+			const char* name;
+		};
+		LatencySource latencySources[] = {
+			{ "loadTyped", in.typedSRV_RGBA32F, "Buffer<RGBA32f>.Load" },
+			{ "loadRaw", in.byteAddressSRV, "ByteAddressBuffer.Load4" },
+			{ "loadStructured", in.structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load" },
+			{ "loadTex", in.texSRV_RGBA32F, "Texture2D<RGBA32F>.Load" } };
+		for (const LatencySource& source : latencySources)
+		{
+			for (unsigned lds : occupancyLdsKB)
+			{
+				ComputePSO& shader = latencyShaders.at(std::string(source.kernel) + "4dLinearAlu" + (lds ? "Lds" + std::to_string(lds) + "k" : ""));
+				std::string ldsName = lds ? " +" + std::to_string(lds) + "KB LDS" : "";
+				std::string sweep = std::string(source.name) + " linear ALU ops per load" + ldsName;
+				for (const auto& [aluOps, cb] : in.aluCBs)
+				{
+					std::string name = std::string(source.name) + " linear " + std::to_string(aluOps) + " ALU ops" + ldsName;
+					bench.sweepTestCase(shader, cb.Get(), source.source, nullptr, name, sweep, aluOps);
+				}
+			}
+		}
+
+		// Address trace replay: the same traced element indices through every view type of the float4 trace sources
+		if (trace)
+		{
+			struct TraceSource
+			{
+				const char* kernel;
+				const ShaderResourceView& source;
+				const char* name;
+			};
+			TraceSource traceSources[] = {
+				{ "loadTyped4dTrace", in.traceTypedSRV, "Buffer<RGBA32f>.Load" },
+				{ "loadRaw4dTrace", in.traceByteAddressSRV, "ByteAddressBuffer.Load4" },
+				{ "loadStructured4dTrace", in.traceStructuredSRV, "StructuredBuffer<float4>.Load" },
+				{ "loadTex4dTrace", in.traceTexSRV, "Texture2D<RGBA32F>.Load" } };
+			for (const TraceSource& source : traceSources)
+				bench.traceTestCase(traceShaders.at(source.kernel), traceCB.Get(), source.source, std::string("Trace: ") + source.name, trace->loadsPerThread);
+		}
+
+		// Root signature layouts. Root SRVs can only be raw and structured buffers.
+		struct RootBindingSource
+		{
+			const char* kernel;
+			const ShaderResourceView& source;
+			const char* name;
+			bool rootDescriptor;
+		};
+		RootBindingSource rootBindingSources[] = {
+			{ "loadTyped", in.typedSRV_RGBA8, "Buffer<RGBA8>.Load", false },
+			{ "loadRaw", in.byteAddressSRV, "ByteAddressBuffer.Load4", true },
+			{ "loadStructured", in.structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load", true },
+			{ "loadTex", in.texSRV_RGBA8, "Texture2D<RGBA8>.Load", false } };
+		for (const RootBindingSource& source : rootBindingSources)
+		{
+			for (auto [pattern, patternName] : patternNames)
+			{
+				std::string directName = std::string(source.name) + " " + patternName;
+				std::string kernelName = std::string(source.kernel) + "4d" + pattern;
+				if (source.rootDescriptor)
+					bench.comparedTestCase(rootBindingShaders.at(kernelName + "RootDescriptor"), in.loadCB.Get(), source.source, directName + " root descriptors", directName, "table");
+				bench.comparedTestCase(rootBindingShaders.at(kernelName + "RootConstants"), in.loadCB.Get(), source.source, directName + " root constants", directName, "table");
+			}
+		}
+
+		// Bindless: dispatch uniform, wave uniform and per lane descriptor heap indices
+		if (bindless)
+		{
+			struct BindlessSource
+			{
+				const char* kernel;
+				ID3D12Resource* cb;
+				const ShaderResourceView& source;
+				const char* name;
+			};
+			BindlessSource bindlessSources[] = {
+				{ "loadTyped", in.bindlessTypedCB.Get(), in.typedSRV_RGBA8, "Buffer<RGBA8>.Load" },
+				{ "loadRaw", in.bindlessByteAddressCB.Get(), in.byteAddressSRV, "ByteAddressBuffer.Load4" },
+				{ "loadStructured", in.bindlessStructuredCB.Get(), in.structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load" },
+				{ "loadTex", in.bindlessTexCB.Get(), in.texSRV_RGBA8, "Texture2D<RGBA8>.Load" } };
+			std::pair<const char*, const char*> patterns[] = { { "Linear", "linear" }, { "Random", "random" } };
+			std::pair<const char*, const char*> bindings[] = {
+				{ "Bindless", "bindless uniform" }, { "BindlessWave", "bindless wave uniform" }, { "BindlessNonUniform", "bindless non-uniform" } };
+
+			for (const BindlessSource& source : bindlessSources)
+			{
+				for (auto [pattern, patternName] : patterns)
+				{
+					std::string directName = std::string(source.name) + " " + patternName;
+					for (auto [binding, bindingName] : bindings)
+					{
+						ComputePSO& shader = bindlessShaders.at(std::string(source.kernel) + "4d" + pattern + binding);
+						bench.comparedTestCase(shader, source.cb, source.source, directName + " " + bindingName, directName, "table");
+					}
+				}
+			}
+		}
 	};
 
-	std::array<TestCaseTiming, maxTestCases> timingResults;
+	// Concurrency test cases: load kernels on the direct queue overlapped with async compute and copy queues
+	auto recordConcurrencyTestCases = [&](const InputResources& in)
+	{
+		// Same memory bound kernel on every queue. Shows whether more queues add any throughput.
+		std::vector<BenchTest::QueueWorkload> sameKernel = {
+			{ .queue = 0, .shader = &shaderLoadRaw4dLinear, .cb = in.loadCB.Get(), .source = &in.byteAddressSRV } };
+		for (unsigned i = 0; i < bench.getComputeQueueCount(); i++)
+			sameKernel.push_back({ .queue = bench.getComputeQueue(i), .shader = &shaderLoadRaw4dLinear, .cb = in.loadCB.Get(), .source = &in.byteAddressSRV });
+		bench.concurrentTestCase(sameKernel, "Async: ByteAddressBuffer.Load4 linear on every queue");
+
+		// Different load paths sharing the L1
+		bench.concurrentTestCase({
+			{ .queue = 0, .shader = &shaderLoadTex4dRandom, .cb = in.loadCB.Get(), .source = &in.texSRV_RGBA8 },
+			{ .queue = bench.getComputeQueue(0), .shader = &shaderLoadRaw4dRandom, .cb = in.loadCB.Get(), .source = &in.byteAddressSRV } },
+			"Async: Texture2D<RGBA8>.Load random + ByteAddressBuffer.Load4 random");
+		bench.concurrentTestCase({
+			{ .queue = 0, .shader = &shaderLoadTyped4dLinear, .cb = in.loadCB.Get(), .source = &in.typedSRV_RGBA32F },
+			{ .queue = bench.getComputeQueue(0), .shader = &shaderSampleTex4dLinear, .cb = in.loadCB.Get(), .source = &in.texSRV_RGBA8, .sampler = &samplerBilinear } },
+			"Async: Buffer<RGBA32f>.Load linear + Texture2D<RGBA8>.Sample(bilinear) linear");
+
+		// Copy engine traffic next to a load kernel
+		bench.concurrentTestCase({
+			{ .queue = 0, .shader = &shaderLoadRaw4dLinear, .cb = in.loadCB.Get(), .source = &in.byteAddressSRV },
+			{ .queue = bench.getCopyQueue() } },
+			"Async: ByteAddressBuffer.Load4 linear + 32MB copy");
+	};
+
+	TimelineTrace timeline;
+	if (!options.timelineFile.empty())
+		dx.setTimeline(&timeline);
 
 	// Frame loop
 	MessageStatus status = MessageStatus::Default;
 	unsigned frameNumber = 0;
 	do
 	{
-		dx.processPerformanceResults([&](float timeMillis, unsigned id, std::string& name)
+		dx.processPerformanceResults(collectResults);
+
+		if (soak && frameNumber >= numWarmUpFramesBeforeBenchmark && !soak->beginFrame(frameNumber))
+			break;
+
+		dx.beginFrame();
+		bench.beginFrame(frameNumber == 0);
+
+		bench.calibrate(shaderEmpty);
+
+		for (auto&& input : inputs)
 		{
-			if (frameNumber >= numWarmUpFramesBeforeBenchmark)
+			bench.setNameSuffix(input->nameSuffix);
+			recordTestCases(*input);
+		}
+
+		if (options.asyncComputeQueues)
+		{
+			bench.setNameSuffix(inputs[0]->nameSuffix);
+			recordConcurrencyTestCases(*inputs[0]);
+		}
+
+		// Instrumented dispatches once, in the last frame. They are not part of the timed test cases.
+		if (waveTimer && frameNumber == numWarmUpFramesBeforeBenchmark + numBenchmarkFrames - 1)
+		{
+			const InputResources& input = *inputs[0];
+			const std::pair<const char*, const ShaderResourceView*> timedSources[] = {
+				{ "loadTyped", &input.typedSRV_RGBA32F },
+				{ "loadRaw", &input.byteAddressSRV },
+				{ "loadStructured", &input.structuredSRV_RGBA32F } };
+			for (auto&& [resource, source] : timedSources)
 			{
-				if (timingResults[id].name == "")
+				for (const char* pattern : { "Linear", "Random" })
 				{
-					timingResults[id] = { name, 0 };
+					std::string kernel = std::string(resource) + "4d" + pattern + "Timed";
+					waveTimer->recordDispatch(kernel + input.nameSuffix, timedShaders.at(kernel), input.loadCB.Get(), *source, uint3(1024, 1024, 1), uint3(256, 1, 1));
 				}
-				timingResults[id].totalTime += timeMillis;
-				timingResults[id].timings.push_back(timeMillis);
 			}
-		});
-
-		dx.beginFrame();
-
-		BenchTest bench(dx, outputUAV);
-
-		bench.testCase(shaderLoadTyped1dInvariant, loadCB.Get(), typedSRV_R8, "Buffer<R8>.Load uniform");
-		bench.testCase(shaderLoadTyped1dLinear, loadCB.Get(), typedSRV_R8, "Buffer<R8>.Load linear");
-		bench.testCase(shaderLoadTyped1dRandom, loadCB.Get(), typedSRV_R8, "Buffer<R8>.Load random");
-		bench.testCase(shaderLoadTyped2dInvariant, loadCB.Get(), typedSRV_RG8, "Buffer<RG8>.Load uniform");
-		bench.testCase(shaderLoadTyped2dLinear, loadCB.Get(), typedSRV_RG8, "Buffer<RG8>.Load linear");
-		bench.testCase(shaderLoadTyped2dRandom, loadCB.Get(), typedSRV_RG8, "Buffer<RG8>.Load random");
-		bench.testCase(shaderLoadTyped4dInvariant, loadCB.Get(), typedSRV_RGBA8, "Buffer<RGBA8>.Load uniform");
-		bench.testCase(shaderLoadTyped4dLinear, loadCB.Get(), typedSRV_RGBA8, "Buffer<RGBA8>.Load linear");
-		bench.testCase(shaderLoadTyped4dRandom, loadCB.Get(), typedSRV_RGBA8, "Buffer<RGBA8>.Load random");
-
-		bench.testCase(shaderLoadTyped1dInvariant, loadCB.Get(), typedSRV_R16F, "Buffer<R16f>.Load uniform");
-		bench.testCase(shaderLoadTyped1dLinear, loadCB.Get(), typedSRV_R16F, "Buffer<R16f>.Load linear");
-		bench.testCase(shaderLoadTyped1dRandom, loadCB.Get(), typedSRV_R16F, "Buffer<R16f>.Load random");
-		bench.testCase(shaderLoadTyped2dInvariant, loadCB.Get(), typedSRV_RG16F, "Buffer<RG16f>.Load uniform");
-		bench.testCase(shaderLoadTyped2dLinear, loadCB.Get(), typedSRV_RG16F, "Buffer<RG16f>.Load linear");
-		bench.testCase(shaderLoadTyped2dRandom, loadCB.Get(), typedSRV_RG16F, "Buffer<RG16f>.Load random");
-		bench.testCase(shaderLoadTyped4dInvariant, loadCB.Get(), typedSRV_RGBA16F, "Buffer<RGBA16f>.Load uniform");
-		bench.testCase(shaderLoadTyped4dLinear, loadCB.Get(), typedSRV_RGBA16F, "Buffer<RGBA16f>.Load linear");
-		bench.testCase(shaderLoadTyped4dRandom, loadCB.Get(), typedSRV_RGBA16F, "Buffer<RGBA16f>.Load random");
-
-		bench.testCase(shaderLoadTyped1dInvariant, loadCB.Get(), typedSRV_R32F, "Buffer<R32f>.Load uniform");
-		bench.testCase(shaderLoadTyped1dLinear, loadCB.Get(), typedSRV_R32F, "Buffer<R32f>.Load linear");
-		bench.testCase(shaderLoadTyped1dRandom, loadCB.Get(), typedSRV_R32F, "Buffer<R32f>.Load random");
-		bench.testCase(shaderLoadTyped2dInvariant, loadCB.Get(), typedSRV_RG32F, "Buffer<RG32f>.Load uniform");
-		bench.testCase(shaderLoadTyped2dLinear, loadCB.Get(), typedSRV_RG32F, "Buffer<RG32f>.Load linear");
-		bench.testCase(shaderLoadTyped2dRandom, loadCB.Get(), typedSRV_RG32F, "Buffer<RG32f>.Load random");
-		bench.testCase(shaderLoadTyped4dInvariant, loadCB.Get(), typedSRV_RGBA32F, "Buffer<RGBA32f>.Load uniform");
-		bench.testCase(shaderLoadTyped4dLinear, loadCB.Get(), typedSRV_RGBA32F, "Buffer<RGBA32f>.Load linear");
-		bench.testCase(shaderLoadTyped4dRandom, loadCB.Get(), typedSRV_RGBA32F, "Buffer<RGBA32f>.Load random");
-
-		bench.testCase(shaderLoadRaw1dInvariant, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load uniform");
-		bench.testCase(shaderLoadRaw1dLinear, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load linear");
-		bench.testCase(shaderLoadRaw1dRandom, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load random");
-		bench.testCase(shaderLoadRaw2dInvariant, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load2 uniform");
-		bench.testCase(shaderLoadRaw2dLinear, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load2 linear");
-		bench.testCase(shaderLoadRaw2dRandom, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load2 random");
-		bench.testCase(shaderLoadRaw3dInvariant, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load3 uniform");
-		bench.testCase(shaderLoadRaw3dLinear, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load3 linear");
-		bench.testCase(shaderLoadRaw3dRandom, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load3 random");
-		bench.testCase(shaderLoadRaw4dInvariant, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load4 uniform");
-		bench.testCase(shaderLoadRaw4dLinear, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load4 linear");
-		bench.testCase(shaderLoadRaw4dRandom, loadCB.Get(), byteAddressSRV, "ByteAddressBuffer.Load4 random");
-
-		bench.testCase(shaderLoadRaw2dInvariant, loadCBUnaligned.Get(), byteAddressSRV, "ByteAddressBuffer.Load2 unaligned uniform");
-		bench.testCase(shaderLoadRaw2dLinear, loadCBUnaligned.Get(), byteAddressSRV, "ByteAddressBuffer.Load2 unaligned linear");
-		bench.testCase(shaderLoadRaw2dRandom, loadCBUnaligned.Get(), byteAddressSRV, "ByteAddressBuffer.Load2 unaligned random");
-		bench.testCase(shaderLoadRaw4dInvariant, loadCBUnaligned.Get(), byteAddressSRV, "ByteAddressBuffer.Load4 unaligned uniform");
-		bench.testCase(shaderLoadRaw4dLinear, loadCBUnaligned.Get(), byteAddressSRV, "ByteAddressBuffer.Load4 unaligned linear");
-		bench.testCase(shaderLoadRaw4dRandom, loadCBUnaligned.Get(), byteAddressSRV, "ByteAddressBuffer.Load4 unaligned random");
-
-		bench.testCase(shaderLoadStructured1dInvariant, loadCB.Get(), structuredSRV_R32F, "StructuredBuffer<float>.Load uniform");
-		bench.testCase(shaderLoadStructured1dLinear, loadCB.Get(), structuredSRV_R32F, "StructuredBuffer<float>.Load linear");
-		bench.testCase(shaderLoadStructured1dRandom, loadCB.Get(), structuredSRV_R32F, "StructuredBuffer<float>.Load random");
-		bench.testCase(shaderLoadStructured2dInvariant, loadCB.Get(), structuredSRV_RG32F, "StructuredBuffer<float2>.Load uniform");
-		bench.testCase(shaderLoadStructured2dLinear, loadCB.Get(), structuredSRV_RG32F, "StructuredBuffer<float2>.Load linear");
-		bench.testCase(shaderLoadStructured2dRandom, loadCB.Get(), structuredSRV_RG32F, "StructuredBuffer<float2>.Load random");
-		bench.testCase(shaderLoadStructured4dInvariant, loadCB.Get(), structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load uniform");
-		bench.testCase(shaderLoadStructured4dLinear, loadCB.Get(), structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load linear");
-		bench.testCase(shaderLoadStructured4dRandom, loadCB.Get(), structuredSRV_RGBA32F, "StructuredBuffer<float4>.Load random");
-
-		bench.testCase(shaderLoadConstant4dInvariant, loadWithArrayCB.Get(), {}, "cbuffer{float4} load uniform");
-		bench.testCase(shaderLoadConstant4dLinear, loadWithArrayCB.Get(), {}, "cbuffer{float4} load linear");
-		bench.testCase(shaderLoadConstant4dRandom, loadWithArrayCB.Get(), {}, "cbuffer{float4} load random");
-
-		bench.testCase(shaderLoadTex1dInvariant, loadCB.Get(), texSRV_R8, "Texture2D<R8>.Load uniform");
-		bench.testCase(shaderLoadTex1dLinear, loadCB.Get(), texSRV_R8, "Texture2D<R8>.Load linear");
-		bench.testCase(shaderLoadTex1dRandom, loadCB.Get(), texSRV_R8, "Texture2D<R8>.Load random");
-		bench.testCase(shaderLoadTex2dInvariant, loadCB.Get(), texSRV_RG8, "Texture2D<RG8>.Load uniform");
-		bench.testCase(shaderLoadTex2dLinear, loadCB.Get(), texSRV_RG8, "Texture2D<RG8>.Load linear");
-		bench.testCase(shaderLoadTex2dRandom, loadCB.Get(), texSRV_RG8, "Texture2D<RG8>.Load random");
-		bench.testCase(shaderLoadTex4dInvariant, loadCB.Get(), texSRV_RGBA8, "Texture2D<RGBA8>.Load uniform");
-		bench.testCase(shaderLoadTex4dLinear, loadCB.Get(), texSRV_RGBA8, "Texture2D<RGBA8>.Load linear");
-		bench.testCase(shaderLoadTex4dRandom, loadCB.Get(), texSRV_RGBA8, "Texture2D<RGBA8>.Load random");
-
-		bench.testCase(shaderLoadTex1dInvariant, loadCB.Get(), texSRV_R16F, "Texture2D<R16F>.Load uniform");
-		bench.testCase(shaderLoadTex1dLinear, loadCB.Get(), texSRV_R16F, "Texture2D<R16F>.Load linear");
-		bench.testCase(shaderLoadTex1dRandom, loadCB.Get(), texSRV_R16F, "Texture2D<R16F>.Load random");
-		bench.testCase(shaderLoadTex2dInvariant, loadCB.Get(), texSRV_RG16F, "Texture2D<RG16F>.Load uniform");
-		bench.testCase(shaderLoadTex2dLinear, loadCB.Get(), texSRV_RG16F, "Texture2D<RG16F>.Load linear");
-		bench.testCase(shaderLoadTex2dRandom, loadCB.Get(), texSRV_RG16F, "Texture2D<RG16F>.Load random");
-		bench.testCase(shaderLoadTex4dInvariant, loadCB.Get(), texSRV_RGBA16F, "Texture2D<RGBA16F>.Load uniform");
-		bench.testCase(shaderLoadTex4dLinear, loadCB.Get(), texSRV_RGBA16F, "Texture2D<RGBA16F>.Load linear");
-		bench.testCase(shaderLoadTex4dRandom, loadCB.Get(), texSRV_RGBA16F, "Texture2D<RGBA16F>.Load random");
-
-		bench.testCase(shaderLoadTex1dInvariant, loadCB.Get(), texSRV_R32F, "Texture2D<R32F>.Load uniform");
-		bench.testCase(shaderLoadTex1dLinear, loadCB.Get(), texSRV_R32F, "Texture2D<R32F>.Load linear");
-		bench.testCase(shaderLoadTex1dRandom, loadCB.Get(), texSRV_R32F, "Texture2D<R32F>.Load random");
-		bench.testCase(shaderLoadTex2dInvariant, loadCB.Get(), texSRV_RG32F, "Texture2D<RG32F>.Load uniform");
-		bench.testCase(shaderLoadTex2dLinear, loadCB.Get(), texSRV_RG32F, "Texture2D<RG32F>.Load linear");
-		bench.testCase(shaderLoadTex2dRandom, loadCB.Get(), texSRV_RG32F, "Texture2D<RG32F>.Load random");
-		bench.testCase(shaderLoadTex4dInvariant, loadCB.Get(), texSRV_RGBA32F, "Texture2D<RGBA32F>.Load uniform");
-		bench.testCase(shaderLoadTex4dLinear, loadCB.Get(), texSRV_RGBA32F, "Texture2D<RGBA32F>.Load linear");
-		bench.testCase(shaderLoadTex4dRandom, loadCB.Get(), texSRV_RGBA32F, "Texture2D<RGBA32F>.Load random");
-
-		bench.testCaseWithSampler(shaderSampleTex1dInvariant, loadCB.Get(), texSRV_R8, samplerNearest, "Texture2D<R8>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex1dLinear, loadCB.Get(), texSRV_R8, samplerNearest, "Texture2D<R8>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex1dRandom, loadCB.Get(), texSRV_R8, samplerNearest, "Texture2D<R8>.Sample(nearest) random");
-		bench.testCaseWithSampler(shaderSampleTex2dInvariant, loadCB.Get(), texSRV_RG8, samplerNearest, "Texture2D<RG8>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex2dLinear, loadCB.Get(), texSRV_RG8, samplerNearest, "Texture2D<RG8>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex2dRandom, loadCB.Get(), texSRV_RG8, samplerNearest, "Texture2D<RG8>.Sample(nearest) random");
-		bench.testCaseWithSampler(shaderSampleTex4dInvariant, loadCB.Get(), texSRV_RGBA8, samplerNearest, "Texture2D<RGBA8>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex4dLinear, loadCB.Get(), texSRV_RGBA8, samplerNearest, "Texture2D<RGBA8>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex4dRandom, loadCB.Get(), texSRV_RGBA8, samplerNearest, "Texture2D<RGBA8>.Sample(nearest) random");
-
-		bench.testCaseWithSampler(shaderSampleTex1dInvariant, loadCB.Get(), texSRV_R16F, samplerNearest, "Texture2D<R16F>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex1dLinear, loadCB.Get(), texSRV_R16F, samplerNearest, "Texture2D<R16F>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex1dRandom, loadCB.Get(), texSRV_R16F, samplerNearest, "Texture2D<R16F>.Sample(nearest) random");
-		bench.testCaseWithSampler(shaderSampleTex2dInvariant, loadCB.Get(), texSRV_RG16F, samplerNearest, "Texture2D<RG16F>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex2dLinear, loadCB.Get(), texSRV_RG16F, samplerNearest, "Texture2D<RG16F>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex2dRandom, loadCB.Get(), texSRV_RG16F, samplerNearest, "Texture2D<RG16F>.Sample(nearest) random");
-		bench.testCaseWithSampler(shaderSampleTex4dInvariant, loadCB.Get(), texSRV_RGBA16F, samplerNearest, "Texture2D<RGBA16F>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex4dLinear, loadCB.Get(), texSRV_RGBA16F, samplerNearest, "Texture2D<RGBA16F>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex4dRandom, loadCB.Get(), texSRV_RGBA16F, samplerNearest, "Texture2D<RGBA16F>.Sample(nearest) random");
-
-		bench.testCaseWithSampler(shaderSampleTex1dInvariant, loadCB.Get(), texSRV_R32F, samplerNearest, "Texture2D<R32F>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex1dLinear, loadCB.Get(), texSRV_R32F, samplerNearest, "Texture2D<R32F>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex1dRandom, loadCB.Get(), texSRV_R32F, samplerNearest, "Texture2D<R32F>.Sample(nearest) random");
-		bench.testCaseWithSampler(shaderSampleTex2dInvariant, loadCB.Get(), texSRV_RG32F, samplerNearest, "Texture2D<RG32F>.Sample(nearest) uniform");
-		bench.testCaseWithSampler(shaderSampleTex2dLinear, loadCB.Get(), texSRV_RG32F, samplerNearest, "Texture2D<RG32F>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex2dRandom, loadCB.Get(), texSRV_RG32F, samplerNearest, "Texture2D<RG32F>.Sample(nearest) random");
-		bench.testCaseWithSampler(shaderSampleTex4dInvariant, loadCB.Get(), texSRV_RGBA32F, samplerNearest, "Texture2D<RGBA32F>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex4dLinear, loadCB.Get(), texSRV_RGBA32F, samplerNearest, "Texture2D<RGBA32F>.Sample(nearest) linear");
-		bench.testCaseWithSampler(shaderSampleTex4dRandom, loadCB.Get(), texSRV_RGBA32F, samplerNearest, "Texture2D<RGBA32F>.Sample(nearest) random");
-
-		bench.testCaseWithSampler(shaderSampleTex1dInvariant, loadCB.Get(), texSRV_R8, samplerBilinear, "Texture2D<R8>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex1dLinear, loadCB.Get(), texSRV_R8, samplerBilinear, "Texture2D<R8>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex1dRandom, loadCB.Get(), texSRV_R8, samplerBilinear, "Texture2D<R8>.Sample(bilinear) random");
-		bench.testCaseWithSampler(shaderSampleTex2dInvariant, loadCB.Get(), texSRV_RG8, samplerBilinear, "Texture2D<RG8>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex2dLinear, loadCB.Get(), texSRV_RG8, samplerBilinear, "Texture2D<RG8>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex2dRandom, loadCB.Get(), texSRV_RG8, samplerBilinear, "Texture2D<RG8>.Sample(bilinear) random");
-		bench.testCaseWithSampler(shaderSampleTex4dInvariant, loadCB.Get(), texSRV_RGBA8, samplerBilinear, "Texture2D<RGBA8>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex4dLinear, loadCB.Get(), texSRV_RGBA8, samplerBilinear, "Texture2D<RGBA8>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex4dRandom, loadCB.Get(), texSRV_RGBA8, samplerBilinear, "Texture2D<RGBA8>.Sample(bilinear) random");
-
-		bench.testCaseWithSampler(shaderSampleTex1dInvariant, loadCB.Get(), texSRV_R16F, samplerBilinear, "Texture2D<R16F>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex1dLinear, loadCB.Get(), texSRV_R16F, samplerBilinear, "Texture2D<R16F>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex1dRandom, loadCB.Get(), texSRV_R16F, samplerBilinear, "Texture2D<R16F>.Sample(bilinear) random");
-		bench.testCaseWithSampler(shaderSampleTex2dInvariant, loadCB.Get(), texSRV_RG16F, samplerBilinear, "Texture2D<RG16F>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex2dLinear, loadCB.Get(), texSRV_RG16F, samplerBilinear, "Texture2D<RG16F>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex2dRandom, loadCB.Get(), texSRV_RG16F, samplerBilinear, "Texture2D<RG16F>.Sample(bilinear) random");
-		bench.testCaseWithSampler(shaderSampleTex4dInvariant, loadCB.Get(), texSRV_RGBA16F, samplerBilinear, "Texture2D<RGBA16F>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex4dLinear, loadCB.Get(), texSRV_RGBA16F, samplerBilinear, "Texture2D<RGBA16F>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex4dRandom, loadCB.Get(), texSRV_RGBA16F, samplerBilinear, "Texture2D<RGBA16F>.Sample(bilinear) random");
-
-		bench.testCaseWithSampler(shaderSampleTex1dInvariant, loadCB.Get(), texSRV_R32F, samplerBilinear, "Texture2D<R32F>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex1dLinear, loadCB.Get(), texSRV_R32F, samplerBilinear, "Texture2D<R32F>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex1dRandom, loadCB.Get(), texSRV_R32F, samplerBilinear, "Texture2D<R32F>.Sample(bilinear) random");
-		bench.testCaseWithSampler(shaderSampleTex2dInvariant, loadCB.Get(), texSRV_RG32F, samplerBilinear, "Texture2D<RG32F>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex2dLinear, loadCB.Get(), texSRV_RG32F, samplerBilinear, "Texture2D<RG32F>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex2dRandom, loadCB.Get(), texSRV_RG32F, samplerBilinear, "Texture2D<RG32F>.Sample(bilinear) random");
-		bench.testCaseWithSampler(shaderSampleTex4dInvariant, loadCB.Get(), texSRV_RGBA32F, samplerBilinear, "Texture2D<RGBA32F>.Sample(bilinear) uniform");
-		bench.testCaseWithSampler(shaderSampleTex4dLinear, loadCB.Get(), texSRV_RGBA32F, samplerBilinear, "Texture2D<RGBA32F>.Sample(bilinear) linear");
-		bench.testCaseWithSampler(shaderSampleTex4dRandom, loadCB.Get(), texSRV_RGBA32F, samplerBilinear, "Texture2D<RGBA32F>.Sample(bilinear) random");
+		}
 
 		dx.presentFrame();
 
@@ -400,43 +1858,274 @@ int main(int argc, char *argv[])
 		{
 			printf(".");
 		}
-		else
+		else if (!soak)
 		{
 			printf("X");
 		}
 	}
-	while (status != MessageStatus::Exit && frameNumber < numBenchmarkFrames + numWarmUpFramesBeforeBenchmark);
+	while (status != MessageStatus::Exit && (soak || frameNumber < numBenchmarkFrames + numWarmUpFramesBeforeBenchmark));
+
+	// Collect the frames still in flight
+	dx.waitForIdle();
+	dx.processPerformanceResults(collectResults);
+
+	if (!options.timelineFile.empty())
+	{
+		dx.setTimeline(nullptr);
+		timeline.addMarkers(readMarkerRing());
+		if (timeline.write(options.timelineFile))
+			printf("\nTimeline written to %s\n", options.timelineFile.c_str());
+		else
+			printf("\nCan't write the timeline to %s\n", options.timelineFile.c_str());
+	}
+
+	if (validator)
+		validator->check();
 
 	// Find comparison case
 	float compareToTime = 1.0f;
-	std::string compareToCase = "Buffer<RGBA8>.Load random";
+	std::string compareToCase = "Buffer<RGBA8>.Load random" + inputs[0]->nameSuffix + (options.batchSize ? " batch serialized" : "");
 	printf("\n\nPerformance compared to %s\n\n", compareToCase.c_str());
 	for (auto&& row : timingResults)
 	{
 		if (row.name == compareToCase)
 		{
-			compareToTime = row.totalTime;
+			compareToTime = (float)row.totalTime;
 			break;
 		}
 	}
 
+	// Fixed overheads measured by the calibration pass. Subtracted from every test case.
+	auto averageTime = [&](int id) { return (float)timingResults[id].mean; };
+	float timestampOverhead = averageTime(bench.getTimestampCalibration());
+	float dispatchOverhead = max((averageTime(bench.getEmptyDispatchCalibration()) - timestampOverhead) / options.repeatCount, 0.0f);
+	printf("Timestamp overhead: %.4fms, empty dispatch overhead: %.4fms\n\n", timestampOverhead, dispatchOverhead);
+
+	// Overhead corrected time of a single repetition. Dispatches of an overlapped batch share one fixed cost.
+	auto correctedTime = [&](int id)
+	{
+		const TestCaseInfo& info = bench.getTestCases()[id];
+		float fixedOverhead = info.syncCalibration >= 0 ? averageTime(info.syncCalibration) : timestampOverhead;
+		float perRepetition = (averageTime(id) - fixedOverhead) / info.repeatCount;
+		return perRepetition - (info.uavBarriers ? info.dispatchCount : 1) * dispatchOverhead;
+	};
+
+	// Loads and bytes of a single repetition. A load of N channels counts as N loads.
+	auto repetitionWork = [](const TestCaseInfo& info)
+	{
+		double threads = (double)info.threadsPerRepetition;
+		double loads = threads * info.loadsPerThread * info.loadWidth;
+		double bytes = threads * info.loadsPerThread * info.bytesPerLoad + info.copyBytes;
+		return std::pair(loads, bytes);
+	};
+
+	// Loads/clock/CU needs the adapter clock and CU count. D3D12 doesn't expose them, they come from the command line.
+	bool perClockMetrics = options.shaderClockMHz > 0.0f && options.computeUnits > 0;
+	printf(
+		"Columns: total, average, std dev, ratio, corrected, loads/ns, GB/s%s%s\n\n",
+		perClockMetrics ? ", loads/clock/CU" : "",
+		options.pipelineStatistics ? ", CS invocations" : "");
+
 	// Print results
-	for (auto&& row : timingResults)
+	ResultFile exportedResults = { .adapter = adapterName };
+	for (unsigned id = 0; id < timingResults.size(); id++)
 	{
+		const TestCaseTiming& row = timingResults[id];
 		if (row.name == "") break;
-		float average = row.totalTime / row.timings.size();
-		float stdDev = 0.0f;
-		for (float t : row.timings)
-			stdDev += std::powf(t - average, 2.0f);
-		stdDev = std::sqrtf(stdDev / row.timings.size());
+
+		const TestCaseInfo& info = bench.getTestCases()[id];
+		if (info.calibration) continue;
+
+		float average = (float)row.mean;
+		float stdDev = (float)std::sqrt(row.squaredDeviations / row.count);
 		printf(
-			"%s: %.3fms %.3fms %.3fms %.3fx\n",
+			"%s: %.3fms %.3fms %.3fms %.3fx",
 			row.name.c_str(),
 			row.totalTime,
 			average,
 			stdDev,
 			compareToTime / row.totalTime);
+
+		float corrected = correctedTime(id);
+		printf(" %.3fms corrected", corrected);
+
+		// Derived throughput of a single repetition. Concurrent test cases sum the work of their queues.
+		auto [loads, bytes] = repetitionWork(info);
+		for (int part : info.serialTestCases)
+		{
+			auto [partLoads, partBytes] = repetitionWork(bench.getTestCases()[part]);
+			loads += partLoads;
+			bytes += partBytes;
+		}
+		double nanoseconds = max(corrected, 1e-6f) * 1e6;
+		printf(" %.1f loads/ns %.1f GB/s", loads / nanoseconds, bytes / nanoseconds);
+		exportedResults.rows.push_back({
+			.name = row.name,
+			.totalMillis = (float)row.totalTime,
+			.averageMillis = average,
+			.ratio = (float)(compareToTime / row.totalTime),
+			.correctedMillis = corrected,
+			.gigabytesPerSecond = (float)(bytes / nanoseconds) });
+		if (perClockMetrics)
+		{
+			double clocks = nanoseconds * options.shaderClockMHz * 1e-3;
+			printf(" %.3f loads/clk/CU", loads / clocks / options.computeUnits);
+		}
+
+		if (options.pipelineStatistics)
+			printf(" %llu CS invocations%s", row.csInvocations, row.invocationMismatch ? " (MISMATCH)" : "");
+
+		// A fast result from a kernel whose loads were optimized away is meaningless
+		if (info.verification && info.verification->status == ShaderVerification::Status::Failed)
+			printf(" (UNVERIFIED: %s)", info.verification->message.c_str());
+		if (info.validation >= 0 && !validator->getResults()[info.validation].passed)
+			printf(" (INVALID)");
+
+		// Batch mode: per-dispatch cost, and for barrier-free batches the gain over the serialized batch
+		if (info.dispatchCount > 1 && info.serialTestCases.empty())
+			printf(" %.4fms/dispatch", corrected / info.dispatchCount);
+		if (info.serializedTestCase >= 0)
+			printf(" %.3fx overlap", timingResults[info.serializedTestCase].totalTime / row.totalTime);
+
+		// Compared variants: cost relative to the baseline test case
+		if (info.baselineTestCase >= 0)
+		{
+			float baseline = correctedTime(info.baselineTestCase);
+			printf(" %+.1f%% vs %s", (corrected - baseline) / max(baseline, 1e-6f) * 100.0f, info.baselineLabel);
+		}
+
+		// Concurrent test cases: gain over running the same workloads one after another
+		if (!info.serialTestCases.empty())
+		{
+			float serialSum = 0.0f;
+			for (int part : info.serialTestCases)
+				serialSum += correctedTime(part);
+			printf(" %.3fx vs serial sum", serialSum / max(corrected, 1e-6f));
+		}
+		printf("\n");
+	}
+
+	if (!options.resultsFile.empty())
+	{
+		if (writeResults(options.resultsFile, exportedResults))
+			printf("\nResults written to %s\n", options.resultsFile.c_str());
+		else
+			printf("\nCan't write the results to %s\n", options.resultsFile.c_str());
+	}
+
+	if (!options.historyFile.empty())
+	{
+		std::string runTime = historyTimeNow();
+		std::vector<HistoryEntry> entries;
+		for (const ResultRow& row : exportedResults.rows)
+		{
+			entries.push_back({
+				.time = runTime,
+				.adapter = adapterName,
+				.driver = driverVersion,
+				.backend = "D3D12",
+				.test = row.name,
+				.averageMillis = row.averageMillis,
+				.correctedMillis = row.correctedMillis,
+				.ratio = row.ratio });
+		}
+		if (appendHistory(options.historyFile, entries))
+			printf("Results appended to the history %s\n", options.historyFile.c_str());
+		else
+			printf("Can't append to the history %s\n", options.historyFile.c_str());
+	}
+
+	// Sweep curves: throughput of every point, and its time relative to the first point
+	std::vector<std::string> sweeps;
+	for (unsigned id = 0; id < timingResults.size() && timingResults[id].name != ""; id++)
+	{
+		const std::string& sweep = bench.getTestCases()[id].sweep;
+		if (!sweep.empty() && std::find(sweeps.begin(), sweeps.end(), sweep) == sweeps.end())
+			sweeps.push_back(sweep);
+	}
+	if (!sweeps.empty())
+		printf("\nSweeps (value: throughput, time relative to the first value):\n\n");
+	for (const std::string& sweep : sweeps)
+	{
+		printf("%s:", sweep.c_str());
+		float first = 0.0f;
+		for (unsigned id = 0; id < timingResults.size() && timingResults[id].name != ""; id++)
+		{
+			const TestCaseInfo& info = bench.getTestCases()[id];
+			if (info.sweep != sweep)
+				continue;
+			float corrected = max(correctedTime(id), 1e-6f);
+			const char* separator = first == 0.0f ? "" : ",";
+			if (first == 0.0f)
+				first = corrected;
+			double bytes = repetitionWork(info).second;
+			printf("%s %u: %.1f GB/s %.2fx", separator, info.sweepValue, bytes / (corrected * 1e6), corrected / first);
+		}
+		printf("\n");
+	}
+
+	// Address trace replay: throughput per resource type, and its time relative to the fastest one
+	if (trace)
+	{
+		float fastest = 0.0f;
+		for (unsigned id = 0; id < timingResults.size() && timingResults[id].name != ""; id++)
+		{
+			if (bench.getTestCases()[id].trace)
+				fastest = fastest == 0.0f ? correctedTime(id) : min(fastest, correctedTime(id));
+		}
+		fastest = max(fastest, 1e-6f);
+
+		printf("\nTrace %s (%u threads, %u loads per thread):\n\n", trace->filename.c_str(), trace->threadCount, trace->loadsPerThread);
+		for (unsigned id = 0; id < timingResults.size() && timingResults[id].name != ""; id++)
+		{
+			const TestCaseInfo& info = bench.getTestCases()[id];
+			if (!info.trace)
+				continue;
+			float corrected = max(correctedTime(id), 1e-6f);
+			double bytes = repetitionWork(info).second;
+			printf("%s: %.1f GB/s %.2fx\n", info.name.c_str(), bytes / (corrected * 1e6), corrected / fastest);
+		}
+	}
+
+	if (waveTimer)
+		waveTimer->report(options.waveTimingFile);
+
+	if (soak)
+		soak->report(options.soakFile);
+
+	if (options.transferBenchmarks)
+	{
+		dx.waitForIdle();
+		TransferBench transferBench(dx);
+		transferBench.run();
+	}
+
+	// Shader verification summary. Fails the run if any kernel was broken by the compiler.
+	int exitCode = 0;
+	if (verifier)
+	{
+		const char* statusNames[] = { "PASSED", "FAILED", "SKIPPED" };
+		printf("\nShader verification:\n");
+		for (auto&& [filename, verification] : verifier->getResults())
+		{
+			printf("%s: %s %s\n", filename.c_str(), statusNames[(int)verification.status], verification.message.c_str());
+			if (verification.status == ShaderVerification::Status::Failed)
+				exitCode = 1;
+		}
+	}
+
+	// Validation summary. Fails the run if any kernel produced wrong data.
+	if (validator)
+	{
+		printf("\nValidation: %u of %u test cases failed\n", validator->getFailureCount(), (unsigned)validator->getResults().size());
+		for (const ValidationResult& result : validator->getResults())
+		{
+			if (!result.passed)
+				printf("%s: %s\n", result.name.c_str(), result.message.c_str());
+		}
+		if (validator->getFailureCount())
+			exitCode = 1;
 	}
 
-	return 0;
+	return exitCode;
 } 
\ No newline at end of file
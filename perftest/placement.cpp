@@ -0,0 +1,144 @@
+#include "placement.h"
+#include <assert.h>
+#include <cstdio>
+
+static constexpr UINT64 placementHeapBytes = 64 * 1024 * 1024;
+static constexpr UINT64 largePageBytes = 2 * 1024 * 1024;
+
+std::optional<PlacementDesc> parsePlacement(const std::string& arg)
+{
+	if (arg == "committed")
+		return PlacementDesc{ .placement = MemoryPlacement::Committed };
+	if (arg == "placed4k")
+		return PlacementDesc{ .placement = MemoryPlacement::Placed, .alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT };
+	if (arg == "placed64k")
+		return PlacementDesc{ .placement = MemoryPlacement::Placed, .alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+	if (arg == "placed2m")
+		return PlacementDesc{ .placement = MemoryPlacement::Placed, .alignment = largePageBytes };
+	if (arg == "aliased")
+		return PlacementDesc{ .placement = MemoryPlacement::Aliased, .alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT };
+	if (arg == "upload")
+		return PlacementDesc{ .placement = MemoryPlacement::Upload };
+	if (arg == "readback")
+		return PlacementDesc{ .placement = MemoryPlacement::Readback };
+	return std::nullopt;
+}
+
+std::string getPlacementName(const PlacementDesc& desc)
+{
+	switch (desc.placement)
+	{
+	case MemoryPlacement::Committed: return "committed";
+	case MemoryPlacement::Placed: return "placed " + std::to_string(desc.alignment / 1024) + "KB";
+	case MemoryPlacement::Aliased: return "aliased";
+	case MemoryPlacement::Upload: return "upload";
+	case MemoryPlacement::Readback: return "readback";
+	}
+	return "";
+}
+
+ResourcePlacer::ResourcePlacer(DirectXDevice& dx, const PlacementDesc& desc, UINT64 largeBufferBytes, UINT64 largeTextureBytes) :
+	dx(dx), desc(desc), bufferHeapBytes(placementHeapBytes + largeBufferBytes), textureHeapBytes(placementHeapBytes + largeTextureBytes)
+{
+	if (desc.placement == MemoryPlacement::Upload)
+		heapProperties = dx.getCustomHeapProperties(D3D12_HEAP_TYPE_UPLOAD);
+	else if (desc.placement == MemoryPlacement::Readback)
+		heapProperties = dx.getCustomHeapProperties(D3D12_HEAP_TYPE_READBACK);
+
+	if (desc.placement != MemoryPlacement::Placed && desc.placement != MemoryPlacement::Aliased)
+		return;
+
+	// Resource heap tier 1 can't mix buffers and textures in a heap. Texture offsets are relative to the heap
+	// start, the 4MB (MSAA) heap alignment keeps 2MB offsets 2MB aligned in memory.
+	bufferHeap = dx.createHeap(bufferHeapBytes, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+	textureHeap = dx.createHeap(textureHeapBytes, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	// Buffers are aligned in the GPU address space, which is what the page tables see. Aliased buffers
+	// all start at the same offset: buffers have a linear layout, so each of them sees the bytes of the
+	// others. Textures have an opaque layout, they are only placed.
+	heapStart = dx.createBuffer(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT / 4, 4, { .heap = bufferHeap.Get() });
+	assert(heapStart);
+	bufferHeapOffset = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	if (desc.placement == MemoryPlacement::Aliased)
+		aliasedBufferOffset = allocate(bufferHeapOffset, bufferHeapBytes, heapStart->GetGPUVirtualAddress(), 0, desc.alignment);
+}
+
+// Offset aligned to the placement alignment, but not to twice of it, so resources don't end up with
+// a larger alignment by accident. 2MB offsets are only aligned to 2MB.
+UINT64 ResourcePlacer::allocate(UINT64& heapOffset, UINT64 heapBytes, UINT64 heapAddress, UINT64 bytes, UINT64 alignment)
+{
+	UINT64 address = (heapAddress + heapOffset + alignment - 1) / alignment * alignment;
+	if (alignment < largePageBytes && address % (alignment * 2) == 0)
+		address += alignment;
+
+	UINT64 offset = address - heapAddress;
+	heapOffset = offset + bytes;
+	assert(heapOffset <= heapBytes);
+	return offset;
+}
+
+void ResourcePlacer::reportFallback(bool& reported, const char* type)
+{
+	if (!reported)
+		printf("%s placement isn't supported for %s, using committed resources\n", getPlacementName(desc).c_str(), type);
+	reported = true;
+}
+
+ComPtr<ID3D12Resource> ResourcePlacer::createBuffer(unsigned numElements, unsigned strideBytes)
+{
+	ResourcePlacement placement = { .heapProperties = heapProperties };
+	UINT64 bytes = (UINT64)numElements * strideBytes;
+	if (bufferHeap && desc.placement == MemoryPlacement::Aliased)
+	{
+		assert(aliasedBufferOffset + bytes <= bufferHeapBytes);
+		placement.heap = bufferHeap.Get();
+		placement.heapOffset = aliasedBufferOffset;
+	}
+	else if (bufferHeap)
+	{
+		// Placed buffers need at least 64KB alignment
+		UINT64 alignment = desc.alignment;
+		if (alignment < D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT)
+		{
+			if (!bufferAlignmentReported)
+				printf("%s placement isn't supported for buffers, placing them at 64KB\n", getPlacementName(desc).c_str());
+			bufferAlignmentReported = true;
+			alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		}
+		placement.heap = bufferHeap.Get();
+		placement.heapOffset = allocate(bufferHeapOffset, bufferHeapBytes, heapStart->GetGPUVirtualAddress(), bytes, alignment);
+	}
+
+	ComPtr<ID3D12Resource> resource = dx.createBuffer(numElements, strideBytes, placement);
+	if (!resource)
+	{
+		reportFallback(bufferFallbackReported, "buffers");
+		resource = dx.createBuffer(numElements, strideBytes);
+	}
+	return resource;
+}
+
+ComPtr<ID3D12Resource> ResourcePlacer::createTexture2d(uint2 dimensions, DXGI_FORMAT format, unsigned mips)
+{
+	ResourcePlacement placement = { .heapProperties = heapProperties };
+	if (textureHeap)
+	{
+		// 4KB alignment is only available for small textures. Offsets are relative to the heap start.
+		UINT64 smallAlignment = desc.alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT ? desc.alignment : 0;
+		D3D12_RESOURCE_ALLOCATION_INFO info = dx.getTexture2dAllocationInfo(dimensions, format, mips, smallAlignment);
+		if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+			info = dx.getTexture2dAllocationInfo(dimensions, format, mips, 0);
+
+		placement.heap = textureHeap.Get();
+		placement.heapOffset = allocate(textureHeapOffset, textureHeapBytes, 0, info.SizeInBytes, max(desc.alignment, info.Alignment));
+		placement.alignment = info.Alignment == D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT ? info.Alignment : 0;
+	}
+
+	ComPtr<ID3D12Resource> resource = dx.createTexture2d(dimensions, format, mips, placement);
+	if (!resource)
+	{
+		reportFallback(textureFallbackReported, "textures");
+		resource = dx.createTexture2d(dimensions, format, mips);
+	}
+	return resource;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "directx.h"
+#include <optional>
+#include <string>
+
+// Memory placement of the benchmark input resources. Page sizes and TLB reach depend on how the
+// memory was allocated, and CPU visible memory is read over the bus on discrete GPUs.
+enum class MemoryPlacement
+{
+	Committed,		// Own allocation in the default heap
+	Placed,			// Suballocated from a shared default heap at a fixed alignment
+	Aliased,		// Placed at 64KB. All buffers share the same memory, textures are only placed.
+	Upload,			// Committed, CPU visible write combined memory (upload heap memory)
+	Readback		// Committed, CPU visible write back memory (readback heap memory)
+};
+
+struct PlacementDesc
+{
+	MemoryPlacement placement = MemoryPlacement::Committed;
+	UINT64 alignment = 0;		// MemoryPlacement::Placed
+};
+
+// "committed", "placed4k", "placed64k", "placed2m", "aliased", "upload" or "readback"
+std::optional<PlacementDesc> parsePlacement(const std::string& arg);
+std::string getPlacementName(const PlacementDesc& desc);
+
+// Creates resources with a placement. Resources the placement doesn't support are committed instead.
+class ResourcePlacer
+{
+public:
+	// The heaps fit the fixed size inputs, plus the bytes of the large buffers and textures
+	ResourcePlacer(DirectXDevice& dx, const PlacementDesc& desc, UINT64 largeBufferBytes = 0, UINT64 largeTextureBytes = 0);
+
+	ComPtr<ID3D12Resource> createBuffer(unsigned numElements, unsigned strideBytes);
+	ComPtr<ID3D12Resource> createTexture2d(uint2 dimensions, DXGI_FORMAT format, unsigned mips);
+
+private:
+	UINT64 allocate(UINT64& heapOffset, UINT64 heapBytes, UINT64 heapAddress, UINT64 bytes, UINT64 alignment);
+	void reportFallback(bool& reported, const char* type);
+
+	DirectXDevice& dx;
+	PlacementDesc desc;
+	D3D12_HEAP_PROPERTIES heapProperties = { .Type = D3D12_HEAP_TYPE_DEFAULT };
+	ComPtr<ID3D12Heap> bufferHeap;
+	ComPtr<ID3D12Heap> textureHeap;
+	ComPtr<ID3D12Resource> heapStart;		// First buffer of the buffer heap, gives its GPU address
+	UINT64 bufferHeapBytes = 0;
+	UINT64 textureHeapBytes = 0;
+	UINT64 bufferHeapOffset = 0;
+	UINT64 textureHeapOffset = 0;
+	UINT64 aliasedBufferOffset = 0;			// MemoryPlacement::Aliased: heap offset of every buffer
+	bool bufferFallbackReported = false;
+	bool textureFallbackReported = false;
+	bool bufferAlignmentReported = false;
+};
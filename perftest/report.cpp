@@ -0,0 +1,252 @@
+#include "report.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+std::string csvQuote(const std::string& text)
+{
+	std::string quoted = "\"";
+	for (char c : text)
+	{
+		if (c == '"')
+			quoted += '"';
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+std::vector<std::string> csvSplit(const std::string& line)
+{
+	std::vector<std::string> fields(1);
+	bool quoted = false;
+	for (size_t i = 0; i < line.size(); i++)
+	{
+		char c = line[i];
+		if (quoted && c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+			fields.back() += line[++i];
+		else if (c == '"')
+			quoted = !quoted;
+		else if (c == ',' && !quoted)
+			fields.emplace_back();
+		else if (c != '\r')
+			fields.back() += c;
+	}
+	return fields;
+}
+
+bool writeResults(const std::string& filename, const ResultFile& results)
+{
+	FILE* file = nullptr;
+	fopen_s(&file, filename.c_str(), "w");
+	if (!file)
+		return false;
+
+	fprintf(file, "adapter,%s\n", csvQuote(results.adapter).c_str());
+	fprintf(file, "name,total_ms,average_ms,ratio,corrected_ms,gb_per_s\n");
+	for (const ResultRow& row : results.rows)
+	{
+		fprintf(file, "%s,%.4f,%.4f,%.4f,%.4f,%.2f\n", csvQuote(row.name).c_str(), row.totalMillis, row.averageMillis,
+			row.ratio, row.correctedMillis, row.gigabytesPerSecond);
+	}
+	fclose(file);
+	return true;
+}
+
+std::optional<ResultFile> loadResults(const std::string& filename)
+{
+	std::ifstream file(filename);
+	std::string line;
+	if (!file || !std::getline(file, line))
+	{
+		printf("Can't read results %s\n", filename.c_str());
+		return {};
+	}
+
+	std::vector<std::string> adapter = csvSplit(line);
+	if (adapter.size() != 2 || adapter[0] != "adapter" || !std::getline(file, line))
+	{
+		printf("Results %s: missing the adapter and header lines\n", filename.c_str());
+		return {};
+	}
+
+	ResultFile results = { .adapter = adapter[1] };
+	unsigned lineNumber = 2;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if (line.empty())
+			continue;
+		std::vector<std::string> fields = csvSplit(line);
+		if (fields.size() != 6)
+		{
+			printf("Results %s:%u: expected 6 fields\n", filename.c_str(), lineNumber);
+			return {};
+		}
+		ResultRow row = { .name = fields[0] };
+		float* values[] = { &row.totalMillis, &row.averageMillis, &row.ratio, &row.correctedMillis, &row.gigabytesPerSecond };
+		for (unsigned i = 0; i < 5; i++)
+			*values[i] = strtof(fields[i + 1].c_str(), nullptr);
+		results.rows.push_back(row);
+	}
+	return results;
+}
+
+// Resource type of a test case: the name up to the first template argument, method or space.
+// "Buffer<R8>.Load linear" and "Buffer<RGBA32f>.Load random" are both "Buffer".
+static std::string category(const std::string& name)
+{
+	size_t end = name.find_first_of("<{.: ");
+	return name.substr(0, end);
+}
+
+static std::string htmlEscape(const std::string& text)
+{
+	std::string escaped;
+	for (char c : text)
+	{
+		if (c == '<')
+			escaped += "&lt;";
+		else if (c == '>')
+			escaped += "&gt;";
+		else if (c == '&')
+			escaped += "&amp;";
+		else
+			escaped += c;
+	}
+	return escaped;
+}
+
+// Markdown table cells can't hold a bare |, and < > would be taken as HTML
+static std::string markdownEscape(const std::string& text)
+{
+	std::string escaped;
+	for (char c : text)
+	{
+		if (c == '|' || c == '<' || c == '>')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+static std::string cellText(const ResultRow& row)
+{
+	char text[64];
+	snprintf(text, sizeof(text), "%.3fms %.3fx", row.totalMillis, row.ratio);
+	return text;
+}
+
+bool writeReport(const std::string& filename, const std::vector<ResultFile>& runs)
+{
+	bool html = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".html") == 0;
+
+	// Test cases of all runs in first seen order, grouped by category
+	std::vector<std::string> categories;
+	std::vector<std::vector<std::string>> categoryNames;
+	for (const ResultFile& run : runs)
+	{
+		for (const ResultRow& row : run.rows)
+		{
+			std::string rowCategory = category(row.name);
+			size_t c = std::find(categories.begin(), categories.end(), rowCategory) - categories.begin();
+			if (c == categories.size())
+			{
+				categories.push_back(rowCategory);
+				categoryNames.emplace_back();
+			}
+			if (std::find(categoryNames[c].begin(), categoryNames[c].end(), row.name) == categoryNames[c].end())
+				categoryNames[c].push_back(row.name);
+		}
+	}
+
+	auto findRow = [](const ResultFile& run, const std::string& name) -> const ResultRow*
+	{
+		for (const ResultRow& row : run.rows)
+		{
+			if (row.name == name)
+				return &row;
+		}
+		return nullptr;
+	};
+
+	std::ostringstream out;
+	if (html)
+		out << "<!DOCTYPE html>\n<html>\n<head><meta charset=\"utf-8\"><title>PerfTest results</title></head>\n<body>\n<h2>Results</h2>\n<h3>Comparison</h3>\n";
+	else
+		out << "## Results\n\n### Comparison\n\n";
+
+	// Ratios are relative to the comparison test case of each run, so they compare across adapters
+	for (size_t c = 0; c < categories.size(); c++)
+	{
+		// Fastest test case of the category per adapter
+		std::vector<const ResultRow*> fastest(runs.size(), nullptr);
+		for (size_t r = 0; r < runs.size(); r++)
+		{
+			for (const std::string& name : categoryNames[c])
+			{
+				const ResultRow* row = findRow(runs[r], name);
+				if (row && (!fastest[r] || row->ratio > fastest[r]->ratio))
+					fastest[r] = row;
+			}
+		}
+
+		if (html)
+		{
+			out << "<h4>" << htmlEscape(categories[c]) << "</h4>\n<table>\n<tr><th>Test case</th>";
+			for (const ResultFile& run : runs)
+				out << "<th>" << htmlEscape(run.adapter) << "</th>";
+			out << "</tr>\n";
+		}
+		else
+		{
+			out << "#### " << markdownEscape(categories[c]) << "\n\n| Test case |";
+			for (const ResultFile& run : runs)
+				out << " " << markdownEscape(run.adapter) << " |";
+			out << "\n|---|";
+			for (size_t r = 0; r < runs.size(); r++)
+				out << "---:|";
+			out << "\n";
+		}
+
+		for (const std::string& name : categoryNames[c])
+		{
+			out << (html ? "<tr><td>" + htmlEscape(name) + "</td>" : "| " + markdownEscape(name) + " |");
+			for (size_t r = 0; r < runs.size(); r++)
+			{
+				const ResultRow* row = findRow(runs[r], name);
+				std::string text = row ? cellText(*row) : "-";
+				bool highlight = row && row == fastest[r];
+				if (html)
+					out << "<td>" << (highlight ? "<b>" + text + "</b>" : text) << "</td>";
+				else
+					out << " " << (highlight ? "**" + text + "**" : text) << " |";
+			}
+			out << (html ? "</tr>\n" : "\n");
+		}
+		out << (html ? "</table>\n" : "\n");
+	}
+
+	// Per adapter listing in the layout of the README result sections
+	for (const ResultFile& run : runs)
+	{
+		if (html)
+			out << "<h3>" << htmlEscape(run.adapter) << "</h3>\n<pre>\n";
+		else
+			out << "### " << run.adapter << "\n```markdown\n";
+		for (const ResultRow& row : run.rows)
+		{
+			std::string line = row.name + ": " + cellText(row);
+			out << (html ? htmlEscape(line) : line) << "\n";
+		}
+		out << (html ? "</pre>\n" : "```\n\n");
+	}
+	if (html)
+		out << "</body>\n</html>\n";
+
+	std::ofstream file(filename);
+	if (!file)
+		return false;
+	file << out.str();
+	return (bool)file;
+}
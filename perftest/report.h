@@ -0,0 +1,34 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <vector>
+
+// Results of one run, exported with -results and read back by the report generator
+struct ResultRow
+{
+	std::string name;
+	float totalMillis;			// Sum over the benchmark frames, the time shown in the README results
+	float averageMillis;
+	float ratio;				// Speed relative to the comparison test case of the run
+	float correctedMillis;		// Average minus the timestamp and dispatch overheads
+	float gigabytesPerSecond;
+};
+
+struct ResultFile
+{
+	std::string adapter;
+	std::vector<ResultRow> rows;
+};
+
+// CSV: an adapter line, a header line, then a line per test case
+bool writeResults(const std::string& filename, const ResultFile& results);
+std::optional<ResultFile> loadResults(const std::string& filename);
+
+// CSV helpers, shared with the results history. Quoted fields may contain commas and doubled quotes.
+std::string csvQuote(const std::string& text);
+std::vector<std::string> csvSplit(const std::string& line);
+
+// README style report of one or more runs: per category tables with a column per adapter and the fastest
+// test case of every column highlighted, followed by the plain result listing of every adapter.
+// HTML if the filename ends with .html, Markdown otherwise.
+bool writeReport(const std::string& filename, const std::vector<ResultFile>& runs);
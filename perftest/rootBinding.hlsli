@@ -0,0 +1,16 @@
+// Root signature variants of a load kernel, include before the kernel body. Define one of:
+// ROOT_DESCRIPTORS: CBV and SRV as root descriptors (raw and structured buffers only)
+// ROOT_CONSTANTS: LoadConstants as root constants, SRV in a descriptor table
+#if defined(ROOT_DESCRIPTORS)
+	#define ROOT_SIGNATURE \
+		"CBV(b0, flags = DATA_VOLATILE)," \
+		"SRV(t0, flags = DATA_VOLATILE)," \
+		"DescriptorTable(" \
+			"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
+#elif defined(ROOT_CONSTANTS)
+	#define ROOT_SIGNATURE \
+		"RootConstants(num32BitConstants = 12, b0)," \
+		"DescriptorTable(" \
+			"SRV(t0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+			"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE))"
+#endif
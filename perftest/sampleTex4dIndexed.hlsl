@@ -0,0 +1,5 @@
+#define LOAD_WIDTH 4
+#define LOAD_INDEXED
+Texture2D<float4> sourceData : register(t0);
+SamplerState texSampler : register(s0); 
+#include "sampleTexBody.hlsli"
@@ -1,4 +1,3 @@
-#include "hash.hlsli"
 #include "loadConstantsGPU.h"
 
 RWBuffer<float> output : register(u0);
@@ -8,10 +7,13 @@ cbuffer CB0 : register(b0)
 	LoadConstants loadConstants;
 };
 
+#include "accessPattern.hlsli"
+
 #define ROOT_SIGNATURE \
 	"DescriptorTable(" \
 		"CBV(b0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
 		"SRV(t0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"\
+		PATTERN_SRVS \
 		"UAV(u0, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE)),"\
 	"DescriptorTable(Sampler(s0))"
 
@@ -25,16 +27,7 @@ void main(uint3 tid : SV_DispatchThreadID, uint3 gid : SV_GroupThreadID)
 {
 	float4 value = 0.0;
 	
-#if defined(LOAD_INVARIANT)
-    // All threads load from same address. Index is wave invariant.
-	uint2 htid = 0;
-#elif defined(LOAD_LINEAR)
-	// Linearly increasing starting address.
-	uint2 htid = gid.xy;
-#elif defined(LOAD_RANDOM)
-    // Randomize start address offset (0-3, 0-3)
-	uint2 htid = uint2((hash1(gid.x) & 0x4), (hash1(gid.y) & 0x4));
-#endif
+	uint2 htid = patternStart2d(gid.xy);
 
 	const float2 invTextureDims = 1.0f / float2(32.0f, 32.0f);
 	const float2 texCenter = invTextureDims * 0.5;
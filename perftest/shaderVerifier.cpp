@@ -0,0 +1,283 @@
+#include "shaderVerifier.h"
+#include "file.h"
+#include <regex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+ShaderVerifier::ShaderVerifier()
+{
+	dxcModule = LoadLibraryA("dxcompiler.dll");
+	if (!dxcModule)
+		return;
+
+	auto createInstance = (DxcCreateInstanceProc)GetProcAddress(dxcModule, "DxcCreateInstance");
+	if (!createInstance ||
+		FAILED(createInstance(CLSID_DxcCompiler, IID_PPV_ARGS(compiler.GetAddressOf()))) ||
+		FAILED(createInstance(CLSID_DxcLibrary, IID_PPV_ARGS(library.GetAddressOf()))))
+	{
+		compiler.Reset();
+		library.Reset();
+	}
+}
+
+ShaderVerifier::~ShaderVerifier()
+{
+	compiler.Reset();
+	library.Reset();
+	if (dxcModule)
+		FreeLibrary(dxcModule);
+}
+
+const ShaderVerification& ShaderVerifier::verify(const std::string& filename, const KernelDesc& kernel)
+{
+	auto iterator = results.find(filename);
+	if (iterator != results.end())
+		return iterator->second;
+
+	ShaderVerification& verification = results[filename];
+	if (!isAvailable())
+	{
+		verification = { ShaderVerification::Status::Skipped, "dxcompiler.dll not found" };
+		return verification;
+	}
+
+	std::vector<unsigned char> shaderBytes = loadFile(filename);
+	Microsoft::WRL::ComPtr<IDxcBlobEncoding> shaderBlob;
+	Microsoft::WRL::ComPtr<IDxcBlobEncoding> disassemblyBlob;
+	HRESULT hr = library->CreateBlobWithEncodingFromPinned(shaderBytes.data(), (UINT32)shaderBytes.size(), 0, shaderBlob.GetAddressOf());
+	if (SUCCEEDED(hr))
+		hr = compiler->Disassemble(shaderBlob.Get(), disassemblyBlob.GetAddressOf());
+	if (FAILED(hr))
+	{
+		verification = { ShaderVerification::Status::Skipped, "not a DXIL shader" };
+		return verification;
+	}
+
+	std::string disassembly((const char*)disassemblyBlob->GetBufferPointer(), disassemblyBlob->GetBufferSize());
+	verification = analyzeDxilLoads(disassembly, kernel);
+	return verification;
+}
+
+ShaderVerification analyzeDxilLoads(const std::string& disassembly, const KernelDesc& kernel)
+{
+	// DXIL operations that implement the benchmarked load of each resource type
+	std::set<std::string> loadOps;
+	switch (kernel.resource)
+	{
+	case KernelResource::Typed:
+		loadOps = { "bufferLoad" };
+		break;
+	case KernelResource::Raw:
+	case KernelResource::Structured:
+	case KernelResource::StructAos:
+	case KernelResource::StructAosRaw:
+	case KernelResource::StructSoa:
+		loadOps = { "bufferLoad", "rawBufferLoad" };
+		break;
+	case KernelResource::Constant:
+		loadOps = { "cbufferLoadLegacy" };
+		break;
+	case KernelResource::Texture:
+		loadOps = { "textureLoad" };
+		break;
+	case KernelResource::SampledTexture:
+		loadOps = { "sampleLevel" };
+		break;
+	}
+
+	// %5 = call %dx.types.ResRet.f32 @dx.op.bufferLoad.f32(i32 68, %dx.types.Handle %1, i32 %4, i32 undef)
+	const std::regex callRegex(R"((%[\w.]+) = call %dx\.types\.[\w.]+ @dx\.op\.(\w+)\.\w+\(i32 \d+, %dx\.types\.Handle (%[\w.]+), ([^,)]+))");
+	// %6 = extractvalue %dx.types.ResRet.f32 %5, 0
+	const std::regex extractRegex(R"(= extractvalue %dx\.types\.[\w.]+ (%[\w.]+), (\d+))");
+
+	// Control flow of the loops: counted loops end with "%n = add i32 %i, STEP", "%c = icmp eq i32 %n, END" and
+	// "br i1 %c, label %exit, label %header" in the latch, and start the induction variable with a phi in the header.
+	// ; <label>:8                                       ; preds = %8, %0
+	const std::regex labelRegex(R"(^(?:; <label>:(\d+)|([\w.]+):))");
+	// br i1 %21, label %22, label %8
+	const std::regex conditionalBranchRegex(R"(\bbr i1 (%[\w.]+), label (%[\w.]+), label (%[\w.]+))");
+	// br label %8
+	const std::regex branchRegex(R"(\bbr label (%[\w.]+))");
+	// %9 = phi i32 [ 0, %0 ], [ %20, %8 ]
+	const std::regex phiRegex(R"((%[\w.]+) = phi i32 \[ (-?\d+), %[\w.]+ \], \[ (%[\w.]+), %[\w.]+ \])");
+	const std::regex phiSwappedRegex(R"((%[\w.]+) = phi i32 \[ (%[\w.]+), %[\w.]+ \], \[ (-?\d+), %[\w.]+ \])");
+	// %20 = add nsw i32 %9, 1
+	const std::regex addRegex(R"((%[\w.]+) = add (?:nuw )?(?:nsw )?i32 (%[\w.]+), (-?\d+))");
+	// %21 = icmp eq i32 %20, 256
+	const std::regex compareRegex(R"((%[\w.]+) = icmp \w+ i32 (%[\w.]+), (-?\d+))");
+
+	struct Branch
+	{
+		unsigned block;
+		std::string target;
+		std::string condition;		// Empty for unconditional branches
+	};
+	struct Phi
+	{
+		int start;
+		std::string next;
+	};
+	struct ConstantOperand
+	{
+		std::string value;
+		int constant;
+	};
+
+	// Basic blocks are numbered in disassembly order, the unnamed entry block is 0
+	unsigned block = 0;
+	std::map<std::string, unsigned> blocks;
+	std::vector<Branch> branches;
+	std::map<std::string, Phi> phis;
+	std::map<std::string, ConstantOperand> adds;
+	std::map<std::string, ConstantOperand> compares;
+
+	std::map<std::string, std::set<unsigned>> loadChannels;
+	std::map<std::string, unsigned> loadBlocks;
+	// Indexed and trace kernels read their addresses from an index buffer, its loads come first
+	bool hasIndexBuffer = kernel.pattern == KernelPattern::Indexed || kernel.pattern == KernelPattern::Trace;
+	std::string indexHandle;
+
+	std::istringstream lines(disassembly);
+	std::string line;
+	std::smatch match;
+	while (std::getline(lines, line))
+	{
+		if (std::regex_search(line, match, labelRegex))
+		{
+			blocks["%" + (match[1].matched ? match[1].str() : match[2].str())] = ++block;
+		}
+		else if (std::regex_search(line, match, callRegex))
+		{
+			if (!loadOps.count(match[2].str()))
+				continue;
+			if (hasIndexBuffer && match[2].str() == "bufferLoad" && (indexHandle.empty() || indexHandle == match[3].str()))
+			{
+				indexHandle = match[3].str();
+				continue;
+			}
+
+			// LoadConstants fields are also read with cbufferLoadLegacy, but with a literal row index
+			if (kernel.resource == KernelResource::Constant && match[4].str().find('%') == std::string::npos)
+				continue;
+
+			loadChannels[match[1].str()];
+			loadBlocks[match[1].str()] = block;
+		}
+		else if (std::regex_search(line, match, extractRegex))
+		{
+			auto load = loadChannels.find(match[1].str());
+			unsigned channel = std::stoi(match[2].str());
+			if (load != loadChannels.end() && channel < 4)		// Channel 4 is the residency status
+				load->second.insert(channel);
+		}
+		else if (std::regex_search(line, match, conditionalBranchRegex))
+		{
+			branches.push_back({ block, match[2].str(), match[1].str() });
+			branches.push_back({ block, match[3].str(), match[1].str() });
+		}
+		else if (std::regex_search(line, match, branchRegex))
+		{
+			branches.push_back({ block, match[1].str(), "" });
+		}
+		else if (std::regex_search(line, match, phiRegex))
+		{
+			phis[match[1].str()] = { std::stoi(match[2].str()), match[3].str() };
+		}
+		else if (std::regex_search(line, match, phiSwappedRegex))
+		{
+			phis[match[1].str()] = { std::stoi(match[3].str()), match[2].str() };
+		}
+		else if (std::regex_search(line, match, addRegex))
+		{
+			adds[match[1].str()] = { match[2].str(), std::stoi(match[3].str()) };
+		}
+		else if (std::regex_search(line, match, compareRegex))
+		{
+			compares[match[1].str()] = { match[2].str(), std::stoi(match[3].str()) };
+		}
+	}
+
+	// A branch back to the same or an earlier block closes a loop. Its trip count is known when the latch
+	// compares the incremented induction variable with a constant, 0 otherwise (runtime trip count).
+	struct Loop
+	{
+		unsigned header;
+		unsigned latch;
+		unsigned tripCount;
+	};
+	std::vector<Loop> loops;
+	for (const Branch& branch : branches)
+	{
+		auto header = blocks.find(branch.target);
+		if (header == blocks.end() || header->second > branch.block)
+			continue;
+
+		Loop loop = { header->second, branch.block, 0 };
+		auto compare = compares.find(branch.condition);
+		auto add = compare != compares.end() ? adds.find(compare->second.value) : adds.end();
+		auto phi = add != adds.end() ? phis.find(add->second.value) : phis.end();
+		if (phi != phis.end() && phi->second.next == add->first && add->second.constant != 0)
+		{
+			int distance = compare->second.constant - phi->second.start;
+			int step = add->second.constant;
+			if (distance % step == 0 && distance / step > 0)
+				loop.tripCount = distance / step;
+		}
+		loops.push_back(loop);
+	}
+
+	if (loadChannels.empty())
+		return { ShaderVerification::Status::Failed, "benchmarked loads were eliminated" };
+
+	// Every load runs once per iteration of each loop around its block
+	unsigned numLoads = (unsigned)loadChannels.size();
+	unsigned loadsInLoops = 0;
+	uint64_t loadsPerThread = 0;
+	bool runtimeTripCount = false;
+	for (auto&& [result, loadBlock] : loadBlocks)
+	{
+		uint64_t executions = 1;
+		bool inLoop = false;
+		for (const Loop& loop : loops)
+		{
+			if (loadBlock < loop.header || loadBlock > loop.latch)
+				continue;
+			inLoop = true;
+			if (loop.tripCount == 0)
+				runtimeTripCount = true;
+			executions *= loop.tripCount;
+		}
+		loadsInLoops += inLoop ? 1 : 0;
+		loadsPerThread += executions;
+	}
+	bool hasLoop = loadsInLoops > 0;
+
+	// Trip counts read from the constant buffer (trace kernels) can't be checked, but the loads must stay in the loop
+	if (runtimeTripCount && loadsInLoops != numLoads)
+		return { ShaderVerification::Status::Failed, std::to_string(numLoads - loadsInLoops) + " load(s) outside of the load loop" };
+	if (!runtimeTripCount && loadsPerThread != kernel.loadsPerThread)
+	{
+		std::string loopMessage = hasLoop ? "" : ", load loop was removed";
+		return {
+			ShaderVerification::Status::Failed,
+			std::to_string(loadsPerThread) + " loads per thread, expected " + std::to_string(kernel.loadsPerThread) + loopMessage };
+	}
+
+	// 64-bit channels may be loaded as pairs of 32-bit channels
+	for (auto&& [result, channels] : loadChannels)
+	{
+		bool splitChannels = getElementBytes(kernel.element) == 8 && channels.size() == kernel.loadWidth * 2;
+		if (channels.size() != kernel.loadWidth && !splitChannels)
+		{
+			return {
+				ShaderVerification::Status::Failed,
+				std::to_string(channels.size()) + " channels per load, expected " + std::to_string(kernel.loadWidth) };
+		}
+	}
+
+	std::string message = hasLoop ?
+		std::to_string(numLoads) + " load(s) per loop iteration" :
+		"fully unrolled";
+	return { ShaderVerification::Status::Passed, message + ", " + std::to_string(kernel.loadWidth) + " channel(s) per load" };
+}
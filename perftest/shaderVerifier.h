@@ -0,0 +1,43 @@
+#pragma once
+#include "kernelDesc.h"
+#include <windows.h>
+#include <dxcapi.h>
+#include <wrl.h>
+#include <map>
+#include <string>
+
+struct ShaderVerification
+{
+	enum class Status
+	{
+		Passed,
+		Failed,
+		Skipped		// No disassembly available (dxcompiler.dll missing or DXBC shader)
+	};
+
+	Status status;
+	std::string message;
+};
+
+// Checks that the compiler didn't defeat the anti-optimization tricks of a kernel: the benchmarked loads
+// must still exist, run loadsPerThread times inside the loops of the kernel, and fetch LOAD_WIDTH channels
+// each (no merged narrow loads).
+// Uses the DXIL disassembler of dxcompiler.dll, which is loaded at runtime.
+class ShaderVerifier
+{
+public:
+	ShaderVerifier();
+	~ShaderVerifier();
+
+	bool isAvailable() const { return compiler.Get() != nullptr; }
+	const ShaderVerification& verify(const std::string& filename, const KernelDesc& kernel);
+	const std::map<std::string, ShaderVerification>& getResults() const { return results; }
+
+private:
+	HMODULE dxcModule = nullptr;
+	Microsoft::WRL::ComPtr<IDxcCompiler> compiler;
+	Microsoft::WRL::ComPtr<IDxcLibrary> library;
+	std::map<std::string, ShaderVerification> results;
+};
+
+ShaderVerification analyzeDxilLoads(const std::string& disassembly, const KernelDesc& kernel);
@@ -0,0 +1,164 @@
+#include "soak.h"
+#include "report.h"
+#include <algorithm>
+#include <cstdio>
+
+SoakRecorder::SoakRecorder(DirectXDevice& dx, double durationSeconds, double windowSeconds) :
+	dx(dx),
+	durationSeconds(durationSeconds),
+	windowSeconds(windowSeconds)
+{
+}
+
+double SoakRecorder::elapsedSeconds() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool SoakRecorder::beginFrame(unsigned frameNumber)
+{
+	if (!started)
+	{
+		start = std::chrono::steady_clock::now();
+		uint64_t gpuFrequency;
+		dx.getClockCalibration(startGpuTimestamp, startCpuTimestamp, gpuFrequency);
+		started = true;
+	}
+
+	double seconds = elapsedSeconds();
+	if (seconds >= durationSeconds)
+		return false;
+
+	// New window: clock drift sample, and a progress mark
+	unsigned window = (unsigned)(seconds / windowSeconds);
+	while (windows.size() <= window)
+	{
+		Window next = { .startSeconds = windows.size() * windowSeconds };
+		uint64_t gpuTimestamp, cpuTimestamp, gpuFrequency;
+		LARGE_INTEGER cpuFrequency;
+		QueryPerformanceFrequency(&cpuFrequency);
+		if (dx.getClockCalibration(gpuTimestamp, cpuTimestamp, gpuFrequency) && cpuTimestamp > startCpuTimestamp)
+		{
+			double gpuSeconds = (double)(gpuTimestamp - startGpuTimestamp) / gpuFrequency;
+			double cpuSeconds = (double)(cpuTimestamp - startCpuTimestamp) / cpuFrequency.QuadPart;
+			next.clockDriftPpm = (gpuSeconds / cpuSeconds - 1.0) * 1e6;
+		}
+		windows.push_back(next);
+		printf("X");
+	}
+
+	frameWindows[frameNumber % frameWindows.size()] = { frameNumber, window };
+	return true;
+}
+
+void SoakRecorder::addResult(unsigned frameNumber, unsigned id, const std::string& name, float millis)
+{
+	const FrameWindow& frameWindow = frameWindows[frameNumber % frameWindows.size()];
+	if (frameWindow.frame != frameNumber)
+		return;
+
+	Window& window = windows[frameWindow.window];
+	if (window.sums.size() <= id)
+	{
+		window.sums.resize(id + 1, 0.0);
+		window.counts.resize(id + 1, 0);
+	}
+	window.sums[id] += millis;
+	window.counts[id]++;
+
+	if (names.size() <= id)
+		names.resize(id + 1);
+	names[id] = name;
+}
+
+double SoakRecorder::windowAverage(const Window& window, unsigned id) const
+{
+	return id < window.counts.size() && window.counts[id] ? window.sums[id] / window.counts[id] : 0.0;
+}
+
+void SoakRecorder::report(const std::string& csvFilename)
+{
+	// The last window is cut short by the end of the run
+	std::vector<Window> complete = windows;
+	if (complete.size() > 1)
+		complete.pop_back();
+	if (complete.empty() || names.empty())
+	{
+		printf("\nSoak: no results\n");
+		return;
+	}
+
+	// Suite time of a window: the sum of its test case averages
+	std::vector<double> suiteTimes;
+	for (const Window& window : complete)
+	{
+		double sum = 0.0;
+		for (unsigned id = 0; id < names.size(); id++)
+			sum += windowAverage(window, id);
+		suiteTimes.push_back(sum);
+	}
+
+	size_t steadyStart = complete.size() - std::max(complete.size() / 4, (size_t)1);
+	auto steadyAverage = [&](auto value)
+	{
+		double sum = 0.0;
+		for (size_t i = steadyStart; i < complete.size(); i++)
+			sum += value(i);
+		return sum / (complete.size() - steadyStart);
+	};
+
+	// Throttled from the first window after which every window is at least 3% slower than cold
+	const double throttleThreshold = 1.03;
+	double cold = suiteTimes[0];
+	double steady = steadyAverage([&](size_t i) { return suiteTimes[i]; });
+	size_t throttleWindow = complete.size();
+	while (throttleWindow > 1 && suiteTimes[throttleWindow - 1] >= cold * throttleThreshold)
+		throttleWindow--;
+
+	printf("\n\nSoak: %.1f minutes, %u windows of %.0fs\n", complete.size() * windowSeconds / 60.0, (unsigned)complete.size(), windowSeconds);
+	printf("Suite time: cold %.3fms, steady state %.3fms (%+.1f%%)\n", cold, steady, (steady / cold - 1.0) * 100.0);
+	if (throttleWindow < complete.size())
+		printf("Throttled after %.1f minutes (every later window at least %.0f%% slower than cold)\n",
+			complete[throttleWindow].startSeconds / 60.0, (throttleThreshold - 1.0) * 100.0);
+	else
+		printf("No sustained slowdown of %.0f%% or more\n", (throttleThreshold - 1.0) * 100.0);
+	printf("GPU timestamp clock drift against the CPU clock: %+.1f ppm at the end\n", complete.back().clockDriftPpm);
+
+	// Test cases with the largest steady state slowdowns
+	std::vector<std::pair<double, unsigned>> changes;
+	for (unsigned id = 0; id < names.size(); id++)
+	{
+		double testCold = windowAverage(complete[0], id);
+		double testSteady = steadyAverage([&](size_t i) { return windowAverage(complete[i], id); });
+		if (testCold > 0.0)
+			changes.push_back({ testSteady / testCold - 1.0, id });
+	}
+	std::sort(changes.begin(), changes.end(), [](auto& a, auto& b) { return a.first > b.first; });
+	printf("\nLargest steady state changes:\n");
+	for (size_t i = 0; i < std::min(changes.size(), (size_t)10); i++)
+	{
+		unsigned id = changes[i].second;
+		printf("%s: cold %.3fms, steady state %.3fms (%+.1f%%)\n", names[id].c_str(), windowAverage(complete[0], id),
+			steadyAverage([&](size_t w) { return windowAverage(complete[w], id); }), changes[i].first * 100.0);
+	}
+
+	if (csvFilename.empty())
+		return;
+	FILE* csv = nullptr;
+	fopen_s(&csv, csvFilename.c_str(), "w");
+	if (!csv)
+	{
+		printf("Can't write %s\n", csvFilename.c_str());
+		return;
+	}
+	fprintf(csv, "window,seconds,clock_drift_ppm,test,average_ms\n");
+	for (size_t w = 0; w < complete.size(); w++)
+	{
+		const Window& window = complete[w];
+		fprintf(csv, "%u,%.1f,%.2f,Suite,%.4f\n", (unsigned)w, window.startSeconds, window.clockDriftPpm, suiteTimes[w]);
+		for (unsigned id = 0; id < names.size(); id++)
+			fprintf(csv, "%u,%.1f,%.2f,%s,%.4f\n", (unsigned)w, window.startSeconds, window.clockDriftPpm, csvQuote(names[id]).c_str(), windowAverage(window, id));
+	}
+	fclose(csv);
+	printf("Soak time series written to %s\n", csvFilename.c_str());
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "directx.h"
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Long running soak mode: the suite runs for a set duration, and every test case gets a time series of
+// fixed length windows. Reports cold (first window) against steady state (last quarter of the windows)
+// times, the time to throttle, and the drift of the GPU timestamp clock against the CPU clock.
+// Core D3D12 has no adapter clock or temperature query. Those need vendor libraries (NVML, ADLX, IGCL).
+class SoakRecorder
+{
+public:
+	SoakRecorder(DirectXDevice& dx, double durationSeconds, double windowSeconds);
+
+	// Call before recording every benchmark frame. Returns false once the duration has passed.
+	bool beginFrame(unsigned frameNumber);
+
+	// Query result of a benchmark frame
+	void addResult(unsigned frameNumber, unsigned id, const std::string& name, float millis);
+
+	// Prints the summary. Writes the window averages of every test case to csvFilename, unless it's empty.
+	void report(const std::string& csvFilename);
+
+private:
+	struct Window
+	{
+		double startSeconds;
+		double clockDriftPpm;			// GPU timestamp clock against the CPU clock, since the start
+		std::vector<double> sums;		// Per test case id
+		std::vector<unsigned> counts;
+	};
+
+	struct FrameWindow
+	{
+		unsigned frame = ~0u;
+		unsigned window = 0;
+	};
+
+	double elapsedSeconds() const;
+	double windowAverage(const Window& window, unsigned id) const;
+
+	DirectXDevice& dx;
+	double durationSeconds;
+	double windowSeconds;
+	std::chrono::steady_clock::time_point start;
+	bool started = false;
+	uint64_t startGpuTimestamp = 0;
+	uint64_t startCpuTimestamp = 0;
+	std::array<FrameWindow, 16> frameWindows;	// Window of the frames whose results are still in flight
+	std::vector<Window> windows;
+	std::vector<std::string> names;			// Per test case id
+};
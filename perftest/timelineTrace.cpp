@@ -0,0 +1,123 @@
+#include "timelineTrace.h"
+#include "gpuMarkers.h"
+#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+
+uint64_t TimelineTrace::cpuTimestamp()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+}
+
+void TimelineTrace::addCalibration(uint64_t gpu, uint64_t cpu, uint64_t gpuTicksPerSecond)
+{
+	if (!cpuFrequency)
+	{
+		LARGE_INTEGER counterFrequency;
+		QueryPerformanceFrequency(&counterFrequency);
+		cpuFrequency = counterFrequency.QuadPart;
+	}
+	gpuFrequency = gpuTicksPerSecond;
+	if (calibrations.empty() || gpu > calibrations.back().gpu)
+		calibrations.push_back({ gpu, cpu });
+}
+
+void TimelineTrace::addCpuSpan(const char* name, unsigned frame, uint64_t start, uint64_t end)
+{
+	spans.push_back({ name, Track::Cpu, false, frame, start, end });
+}
+
+void TimelineTrace::addGpuSpan(const std::string& name, unsigned frame, uint64_t start, uint64_t end)
+{
+	spans.push_back({ name, Track::Gpu, false, frame, start, end });
+}
+
+// Begin and end pairs become spans. Ends whose begin was overwritten in the ring are dropped.
+void TimelineTrace::addMarkers(const std::vector<MarkerRecord>& markers)
+{
+	std::vector<const MarkerRecord*> open;
+	for (const MarkerRecord& marker : markers)
+	{
+		if (marker.type == MarkerRecord::Type::Begin)
+			open.push_back(&marker);
+		else if (marker.type == MarkerRecord::Type::Set)
+			spans.push_back({ marker.name, Track::Markers, true, 0, marker.cpuTimestamp, marker.cpuTimestamp });
+		else if (!open.empty())
+		{
+			spans.push_back({ open.back()->name, Track::Markers, false, 0, open.back()->cpuTimestamp, marker.cpuTimestamp });
+			open.pop_back();
+		}
+	}
+}
+
+// Microseconds since the first calibration
+double TimelineTrace::cpuMicros(uint64_t cpu) const
+{
+	return (double)(int64_t)(cpu - calibrations[0].cpu) * 1e6 / (double)cpuFrequency;
+}
+
+double TimelineTrace::gpuMicros(uint64_t gpu) const
+{
+	if (calibrations.size() == 1)
+		return cpuMicros(calibrations[0].cpu) + (double)(int64_t)(gpu - calibrations[0].gpu) * 1e6 / (double)gpuFrequency;
+
+	// The segment around the timestamp, or the first or last one outside of the calibrated range
+	auto next = std::upper_bound(calibrations.begin(), calibrations.end(), gpu, [](uint64_t value, const Calibration& c) { return value < c.gpu; });
+	size_t segment = std::clamp<size_t>(next - calibrations.begin(), 1, calibrations.size() - 1);
+	const Calibration& a = calibrations[segment - 1];
+	const Calibration& b = calibrations[segment];
+	double cpuPerGpuTick = (double)(b.cpu - a.cpu) / (double)(b.gpu - a.gpu);
+	return cpuMicros(a.cpu) + (double)(int64_t)(gpu - a.gpu) * cpuPerGpuTick * 1e6 / (double)cpuFrequency;
+}
+
+static std::string jsonEscape(const std::string& text)
+{
+	std::string escaped;
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		if ((unsigned char)c >= 0x20)
+			escaped += c;
+	}
+	return escaped;
+}
+
+bool TimelineTrace::write(const std::string& filename) const
+{
+	if (calibrations.empty())
+		return false;
+
+	FILE* file = nullptr;
+	fopen_s(&file, filename.c_str(), "w");
+	if (!file)
+		return false;
+
+	// One process, the tracks as its threads
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"perftest\"}},\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU direct queue\"}},\n");
+	fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":3,\"args\":{\"name\":\"Markers (recorded)\"}}");
+	const char* categories[] = { "", "cpu", "gpu", "marker" };
+	for (const Span& span : spans)
+	{
+		bool gpu = span.track == Track::Gpu;
+		double start = gpu ? gpuMicros(span.start) : cpuMicros(span.start);
+		double end = gpu ? gpuMicros(span.end) : cpuMicros(span.end);
+		if (span.instant)
+			fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+				jsonEscape(span.name).c_str(), categories[(int)span.track], (int)span.track, start);
+		else if (span.track == Track::Markers)
+			fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				jsonEscape(span.name).c_str(), categories[(int)span.track], (int)span.track, start, max(end - start, 0.0));
+		else
+			fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+				jsonEscape(span.name).c_str(), categories[(int)span.track], (int)span.track, start, max(end - start, 0.0), span.frame);
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct MarkerRecord;
+
+// Timeline of the run in the Chrome trace event format (chrome://tracing, ui.perfetto.dev): CPU frame
+// recording, submission and fence wait spans, and a GPU span per performance query. GPU timestamps are
+// converted to CPU time with the clock calibration samples, interpolated between the nearest two, so
+// clock drift during the run doesn't shift the GPU spans against the CPU spans. Ring buffer markers
+// (gpuMarkers.h) get their own track, at their recording time.
+class TimelineTrace
+{
+public:
+	// CPU time in QueryPerformanceCounter ticks, the CPU clock of the D3D12 clock calibration
+	static uint64_t cpuTimestamp();
+
+	void addCalibration(uint64_t gpu, uint64_t cpu, uint64_t gpuTicksPerSecond);
+	void addCpuSpan(const char* name, unsigned frame, uint64_t start, uint64_t end);
+	void addGpuSpan(const std::string& name, unsigned frame, uint64_t start, uint64_t end);
+	void addMarkers(const std::vector<MarkerRecord>& markers);
+
+	// Writes the JSON trace. Returns false if nothing was calibrated or the file can't be written.
+	bool write(const std::string& filename) const;
+
+private:
+	// Thread ids of the trace
+	enum class Track
+	{
+		Cpu = 1,
+		Gpu = 2,
+		Markers = 3
+	};
+
+	struct Span
+	{
+		std::string name;
+		Track track;
+		bool instant;		// Markers set without a begin and end
+		unsigned frame;
+		uint64_t start;		// Ticks of the CPU or the GPU clock
+		uint64_t end;
+	};
+
+	struct Calibration
+	{
+		uint64_t gpu;
+		uint64_t cpu;
+	};
+
+	double cpuMicros(uint64_t cpu) const;
+	double gpuMicros(uint64_t gpu) const;
+
+	std::vector<Span> spans;
+	std::vector<Calibration> calibrations;		// In GPU timestamp order
+	uint64_t gpuFrequency = 0;
+	uint64_t cpuFrequency = 0;
+};
@@ -0,0 +1,335 @@
+#include "transferBench.h"
+#include "inputContent.h"
+#include <assert.h>
+#include <cfloat>
+#include <chrono>
+
+static const unsigned maxTransferBytes = 64 << 20;
+
+// Enough copies per measurement to amortize submission, without making the large sizes slow
+static unsigned getCopyCount(unsigned bytes)
+{
+	return min(max((256u << 20) / bytes, 4u), 256u);
+}
+
+static std::string formatBytes(uint64_t bytes)
+{
+	if (bytes >= (1 << 20))
+		return std::to_string(bytes >> 20) + "MB";
+	return std::to_string(bytes >> 10) + "KB";
+}
+
+static double elapsedMillis(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+TransferBench::TransferBench(DirectXDevice& dx) :
+	dx(dx)
+{
+	fenceEvent = CreateEvent(nullptr, false, false, nullptr);
+	assert(fenceEvent);
+
+	D3D12_FEATURE_DATA_D3D12_OPTIONS3 options3 = {};
+	dx.getDevice()->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS3, &options3, sizeof(options3));
+
+	initQueue(directQueue, dx.getCmdQueue(), D3D12_COMMAND_LIST_TYPE_DIRECT, true);
+	initQueue(copyQueue, nullptr, D3D12_COMMAND_LIST_TYPE_COPY, options3.CopyQueueTimestampQueriesSupported);
+
+	// Incompressible source data for the CPU side copies
+	hostData = generateBufferContent({ .content = InputContent::Random }, maxTransferBytes);
+}
+
+TransferBench::~TransferBench()
+{
+	signalAndWait(directQueue);
+	signalAndWait(copyQueue);
+	CloseHandle(fenceEvent);
+}
+
+void TransferBench::initQueue(Queue& queue, ID3D12CommandQueue* existingQueue, D3D12_COMMAND_LIST_TYPE type, bool timestamps)
+{
+	ID3D12Device* device = dx.getDevice();
+	HRESULT result;
+	if (existingQueue)
+	{
+		queue.queue = existingQueue;
+	}
+	else
+	{
+		D3D12_COMMAND_QUEUE_DESC queueDesc =
+		{
+			.Type = type,
+			.NodeMask = 1
+		};
+		result = device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(queue.queue.GetAddressOf()));
+		assert(SUCCEEDED(result));
+	}
+
+	result = device->CreateCommandAllocator(type, IID_PPV_ARGS(queue.cmdAllocator.GetAddressOf()));
+	assert(SUCCEEDED(result));
+	result = device->CreateCommandList(0, type, queue.cmdAllocator.Get(), nullptr, IID_PPV_ARGS(queue.cmdList.GetAddressOf()));
+	assert(SUCCEEDED(result));
+	queue.cmdList->Close();
+
+	result = device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(queue.fence.GetAddressOf()));
+	assert(SUCCEEDED(result));
+
+	if (timestamps)
+	{
+		D3D12_QUERY_HEAP_DESC queryHeapDesc = {
+			.Type = type == D3D12_COMMAND_LIST_TYPE_COPY ? D3D12_QUERY_HEAP_TYPE_COPY_QUEUE_TIMESTAMP : D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+			.Count = 2 };
+		result = device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(queue.queryHeap.GetAddressOf()));
+		assert(SUCCEEDED(result));
+		queue.queryResultBuffer = dx.createReadbackBuffer(2 * sizeof(uint64_t));
+		result = queue.queue->GetTimestampFrequency(&queue.timestampFrequency);
+		assert(SUCCEEDED(result));
+	}
+}
+
+void TransferBench::signalAndWait(Queue& queue)
+{
+	queue.queue->Signal(queue.fence.Get(), ++queue.fenceValue);
+	if (queue.fence->GetCompletedValue() < queue.fenceValue)
+	{
+		HRESULT result = queue.fence->SetEventOnCompletion(queue.fenceValue, fenceEvent);
+		assert(SUCCEEDED(result));
+		WaitForSingleObject(fenceEvent, INFINITE);
+	}
+}
+
+TransferBench::Timing TransferBench::executeTimed(Queue& queue, const std::function<void(ID3D12GraphicsCommandList*)>& record)
+{
+	queue.cmdAllocator->Reset();
+	queue.cmdList->Reset(queue.cmdAllocator.Get(), nullptr);
+	if (queue.queryHeap)
+		queue.cmdList->EndQuery(queue.queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
+	record(queue.cmdList.Get());
+	if (queue.queryHeap)
+	{
+		queue.cmdList->EndQuery(queue.queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 1);
+		queue.cmdList->ResolveQueryData(queue.queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0, 2, queue.queryResultBuffer.Get(), 0);
+	}
+	queue.cmdList->Close();
+
+	auto start = std::chrono::steady_clock::now();
+	auto cmdListToSubmit = (ID3D12CommandList*)queue.cmdList.Get();
+	queue.queue->ExecuteCommandLists(1, &cmdListToSubmit);
+	signalAndWait(queue);
+	double cpuMillis = elapsedMillis(start);
+
+	if (!queue.queryHeap)
+		return { cpuMillis, false };
+
+	uint64_t timestamps[2];
+	dx.readBuffer(queue.queryResultBuffer.Get(), timestamps, sizeof(timestamps));
+	return { (double)(timestamps[1] - timestamps[0]) / queue.timestampFrequency * 1000.0, true };
+}
+
+void TransferBench::printResult(const std::string& name, uint64_t bytes, Timing timing)
+{
+	double gigabytesPerSecond = bytes / max(timing.millis, 1e-6) * 1e-6;
+	printf("%s: %.3fms %.2f GB/s%s\n", name.c_str(), timing.millis, gigabytesPerSecond, timing.gpuTimed ? "" : " (CPU timed)");
+}
+
+void TransferBench::benchmarkBufferUpload(Queue& queue, const char* queueName, unsigned bytes)
+{
+	ComPtr<ID3D12Resource> source = dx.createUploadBuffer(bytes);
+	ComPtr<ID3D12Resource> destination = dx.createBuffer(bytes / 4, 4);
+	dx.writeBuffer(source.Get(), hostData.data(), bytes);
+
+	// Best of a few runs. The first run also pages in the resources.
+	unsigned copies = getCopyCount(bytes);
+	Timing best = { DBL_MAX, false };
+	for (unsigned run = 0; run < 3; run++)
+	{
+		Timing timing = executeTimed(queue, [&](ID3D12GraphicsCommandList* cmdList)
+		{
+			for (unsigned i = 0; i < copies; i++)
+				cmdList->CopyBufferRegion(destination.Get(), 0, source.Get(), 0, bytes);
+		});
+		if (timing.millis < best.millis)
+			best = timing;
+	}
+	printResult("Upload buffer " + formatBytes(bytes) + " (" + queueName + " queue)", (uint64_t)copies * bytes, best);
+}
+
+void TransferBench::benchmarkTextureUpload(unsigned width, unsigned height)
+{
+	ComPtr<ID3D12Resource> texture = dx.createTexture2d(uint2(width, height), DXGI_FORMAT_R8G8B8A8_UNORM, 1);
+
+	// Staging rows are padded to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT. The CPU side repack is timed separately.
+	D3D12_RESOURCE_DESC desc = texture->GetDesc();
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	UINT numRows;
+	UINT64 rowBytes;
+	UINT64 totalBytes;
+	dx.getDevice()->GetCopyableFootprints(&desc, 0, 1, 0, &footprint, &numRows, &rowBytes, &totalBytes);
+
+	ComPtr<ID3D12Resource> staging = dx.createUploadBuffer((unsigned)totalBytes);
+	unsigned char* ptr = nullptr;
+	D3D12_RANGE readRange = {};
+	HRESULT result = staging->Map(0, &readRange, (void**)&ptr);
+	assert(SUCCEEDED(result));
+	auto repackStart = std::chrono::steady_clock::now();
+	for (UINT row = 0; row < numRows; row++)
+		memcpy(ptr + footprint.Offset + row * footprint.Footprint.RowPitch, hostData.data() + row * rowBytes, rowBytes);
+	double repackMillis = elapsedMillis(repackStart);
+	staging->Unmap(0, nullptr);
+
+	D3D12_TEXTURE_COPY_LOCATION dst = {
+		.pResource = texture.Get(),
+		.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX,
+		.SubresourceIndex = 0 };
+	D3D12_TEXTURE_COPY_LOCATION src = {
+		.pResource = staging.Get(),
+		.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT,
+		.PlacedFootprint = footprint };
+
+	unsigned bytes = width * height * 4;
+	unsigned copies = getCopyCount(bytes);
+	Timing best = { DBL_MAX, false };
+	for (unsigned run = 0; run < 3; run++)
+	{
+		Timing timing = executeTimed(directQueue, [&](ID3D12GraphicsCommandList* cmdList)
+		{
+			for (unsigned i = 0; i < copies; i++)
+				cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+		});
+		if (timing.millis < best.millis)
+			best = timing;
+	}
+
+	std::string name = "Upload texture RGBA8 " + std::to_string(width) + "x" + std::to_string(height) +
+		" (row " + std::to_string(rowBytes) + " bytes, pitch " + std::to_string(footprint.Footprint.RowPitch) + ")";
+	printResult(name, (uint64_t)copies * bytes, best);
+	printResult(name + " CPU repack", bytes, { repackMillis, false });
+}
+
+void TransferBench::benchmarkRingBuffer(unsigned bytes)
+{
+	// Streaming pattern: a persistently mapped upload ring. The CPU fills one segment while the copy
+	// queue drains the others, and only waits when it would overwrite a segment still in flight.
+	const unsigned numSegments = 3;
+	ComPtr<ID3D12Resource> ring = dx.createUploadBuffer(numSegments * bytes);
+	ComPtr<ID3D12Resource> destination = dx.createBuffer(bytes / 4, 4);
+
+	std::array<ComPtr<ID3D12CommandAllocator>, numSegments> allocators;
+	std::array<UINT64, numSegments> segmentFenceValues = {};
+	for (auto& allocator : allocators)
+	{
+		HRESULT result = dx.getDevice()->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(allocator.GetAddressOf()));
+		assert(SUCCEEDED(result));
+	}
+
+	unsigned char* ringPtr = nullptr;
+	D3D12_RANGE readRange = {};
+	HRESULT result = ring->Map(0, &readRange, (void**)&ringPtr);
+	assert(SUCCEEDED(result));
+
+	unsigned copies = getCopyCount(bytes);
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned i = 0; i < copies; i++)
+	{
+		unsigned segment = i % numSegments;
+		if (copyQueue.fence->GetCompletedValue() < segmentFenceValues[segment])
+		{
+			result = copyQueue.fence->SetEventOnCompletion(segmentFenceValues[segment], fenceEvent);
+			assert(SUCCEEDED(result));
+			WaitForSingleObject(fenceEvent, INFINITE);
+		}
+
+		memcpy(ringPtr + segment * bytes, hostData.data(), bytes);
+
+		allocators[segment]->Reset();
+		copyQueue.cmdList->Reset(allocators[segment].Get(), nullptr);
+		copyQueue.cmdList->CopyBufferRegion(destination.Get(), 0, ring.Get(), segment * bytes, bytes);
+		copyQueue.cmdList->Close();
+
+		auto cmdListToSubmit = (ID3D12CommandList*)copyQueue.cmdList.Get();
+		copyQueue.queue->ExecuteCommandLists(1, &cmdListToSubmit);
+		copyQueue.queue->Signal(copyQueue.fence.Get(), ++copyQueue.fenceValue);
+		segmentFenceValues[segment] = copyQueue.fenceValue;
+	}
+	signalAndWait(copyQueue);
+	double millis = elapsedMillis(start);
+
+	ring->Unmap(0, nullptr);
+	printResult("Upload ring buffer " + formatBytes(bytes) + " (persistently mapped, 3 segments, copy queue)", (uint64_t)copies * bytes, { millis, false });
+}
+
+void TransferBench::benchmarkMapPerUpload(unsigned bytes)
+{
+	// The updateConstantBuffer pattern: Map/memcpy/Unmap for every update, and a blocking copy
+	ComPtr<ID3D12Resource> staging = dx.createUploadBuffer(bytes);
+	ComPtr<ID3D12Resource> destination = dx.createBuffer(bytes / 4, 4);
+
+	unsigned copies = getCopyCount(bytes);
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned i = 0; i < copies; i++)
+	{
+		dx.writeBuffer(staging.Get(), hostData.data(), bytes);
+		executeTimed(copyQueue, [&](ID3D12GraphicsCommandList* cmdList)
+		{
+			cmdList->CopyBufferRegion(destination.Get(), 0, staging.Get(), 0, bytes);
+		});
+	}
+	double millis = elapsedMillis(start);
+	printResult("Upload map/memcpy/unmap + wait " + formatBytes(bytes) + " (copy queue)", (uint64_t)copies * bytes, { millis, false });
+}
+
+void TransferBench::benchmarkReadback(unsigned bytes)
+{
+	ComPtr<ID3D12Resource> source = dx.createBuffer(bytes / 4, 4);
+	ComPtr<ID3D12Resource> readback = dx.createReadbackBuffer(bytes);
+
+	unsigned copies = getCopyCount(bytes);
+	Timing best = { DBL_MAX, false };
+	for (unsigned run = 0; run < 3; run++)
+	{
+		Timing timing = executeTimed(directQueue, [&](ID3D12GraphicsCommandList* cmdList)
+		{
+			for (unsigned i = 0; i < copies; i++)
+				cmdList->CopyBufferRegion(readback.Get(), 0, source.Get(), 0, bytes);
+		});
+		if (timing.millis < best.millis)
+			best = timing;
+	}
+	printResult("Readback copy " + formatBytes(bytes) + " (direct queue)", (uint64_t)copies * bytes, best);
+
+	// CPU reads of the readback heap (write-back cached memory)
+	std::vector<unsigned char> hostCopy(bytes);
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned i = 0; i < copies; i++)
+		dx.readBuffer(readback.Get(), hostCopy.data(), bytes);
+	printResult("Readback CPU read " + formatBytes(bytes), (uint64_t)copies * bytes, { elapsedMillis(start), false });
+}
+
+void TransferBench::run()
+{
+	printf("\nTransfer benchmarks:\n\n");
+	if (!copyQueue.queryHeap)
+		printf("Copy queue timestamps are not supported. Copy queue transfers are timed on the CPU.\n");
+
+	const unsigned sizes[] = { 64 << 10, 256 << 10, 1 << 20, 4 << 20, 16 << 20, maxTransferBytes };
+	for (unsigned bytes : sizes)
+	{
+		benchmarkBufferUpload(directQueue, "direct", bytes);
+		benchmarkBufferUpload(copyQueue, "copy", bytes);
+	}
+	for (unsigned bytes : sizes)
+		benchmarkRingBuffer(bytes);
+	for (unsigned bytes : sizes)
+		benchmarkMapPerUpload(bytes);
+
+	// Power of two widths have 256 byte aligned rows. One texel narrower forces padded rows.
+	for (unsigned dim = 128; dim <= 4096; dim *= 2)
+	{
+		benchmarkTextureUpload(dim, dim);
+		benchmarkTextureUpload(dim - 1, dim);
+	}
+
+	for (unsigned bytes : sizes)
+		benchmarkReadback(bytes);
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "directx.h"
+
+// Host <-> GPU transfer benchmarks: upload heap to default heap copies on the direct and copy queues,
+// texture uploads with aligned and padded row pitches, a persistently mapped upload ring buffer, and
+// readback. Every benchmark runs across a range of transfer sizes.
+class TransferBench
+{
+public:
+	TransferBench(DirectXDevice& dx);
+	~TransferBench();
+
+	// Runs the suite and prints the results. The direct queue must be idle.
+	void run();
+
+private:
+	struct Queue
+	{
+		ComPtr<ID3D12CommandQueue> queue;
+		ComPtr<ID3D12CommandAllocator> cmdAllocator;
+		ComPtr<ID3D12GraphicsCommandList> cmdList;
+		ComPtr<ID3D12Fence> fence;
+		UINT64 fenceValue = 0;
+		ComPtr<ID3D12QueryHeap> queryHeap;			// Null if the queue doesn't support timestamps
+		ComPtr<ID3D12Resource> queryResultBuffer;
+		uint64_t timestampFrequency = 0;
+	};
+
+	struct Timing
+	{
+		double millis;
+		bool gpuTimed;
+	};
+
+	void initQueue(Queue& queue, ID3D12CommandQueue* existingQueue, D3D12_COMMAND_LIST_TYPE type, bool timestamps);
+	void signalAndWait(Queue& queue);
+
+	// Executes the recorded commands between a timestamp pair and waits for them. Queues without
+	// timestamp support are timed on the CPU, including submission.
+	Timing executeTimed(Queue& queue, const std::function<void(ID3D12GraphicsCommandList*)>& record);
+
+	void benchmarkBufferUpload(Queue& queue, const char* queueName, unsigned bytes);
+	void benchmarkTextureUpload(unsigned width, unsigned height);
+	void benchmarkRingBuffer(unsigned bytes);
+	void benchmarkMapPerUpload(unsigned bytes);
+	void benchmarkReadback(unsigned bytes);
+
+	void printResult(const std::string& name, uint64_t bytes, Timing timing);
+
+	DirectXDevice& dx;
+	HANDLE fenceEvent;
+	Queue directQueue;
+	Queue copyQueue;
+	std::vector<unsigned char> hostData;
+};
@@ -0,0 +1,525 @@
+#include "validation.h"
+#include "loadConstantsGPU.h"
+#include <assert.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+
+static float halfToFloat(uint16_t half)
+{
+	uint32_t sign = (half >> 15) & 1;
+	int32_t exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x3ff;
+
+	float value;
+	if (exponent == 0)
+		value = std::ldexp((float)mantissa, -24);
+	else if (exponent == 31)
+		value = mantissa ? NAN : INFINITY;
+	else
+		value = std::ldexp((float)(mantissa | 0x400), exponent - 25);
+	return sign ? -value : value;
+}
+
+static uint16_t doubleToHalf(double value)
+{
+	uint16_t sign = std::signbit(value) ? 0x8000 : 0;
+	value = std::fabs(value);
+	if (std::isnan(value))
+		return sign | 0x7e00;
+	if (value >= 65520.0)
+		return sign | 0x7c00;		// Rounds to infinity
+	if (value < std::ldexp(1.0, -14))
+		return sign | (uint16_t)std::nearbyint(value * 16777216.0);		// Denormal, multiples of 2^-24
+
+	// Round to nearest even 11 bit significand
+	int exponent;
+	std::frexp(value, &exponent);
+	uint32_t significand = (uint32_t)std::nearbyint(std::ldexp(value, 11 - exponent));
+	if (significand == 2048)
+	{
+		significand = 1024;
+		exponent++;
+	}
+	int biasedExponent = exponent - 1 + 15;
+	if (biasedExponent >= 31)
+		return sign | 0x7c00;
+	return sign | (uint16_t)(biasedExponent << 10) | (uint16_t)(significand & 0x3ff);
+}
+
+static float4 decodeFormat(DXGI_FORMAT format, const unsigned char* ptr)
+{
+	// Missing channels are (0, 0, 0, 1), same as a typed load
+	float channels[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	unsigned numChannels = 0;
+	switch (format)
+	{
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		numChannels = format == DXGI_FORMAT_R8_UNORM ? 1 : format == DXGI_FORMAT_R8G8_UNORM ? 2 : 4;
+		for (unsigned c = 0; c < numChannels; c++)
+			channels[c] = ptr[c] / 255.0f;
+		break;
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		numChannels = format == DXGI_FORMAT_R16_FLOAT ? 1 : format == DXGI_FORMAT_R16G16_FLOAT ? 2 : 4;
+		for (unsigned c = 0; c < numChannels; c++)
+		{
+			uint16_t half;
+			memcpy(&half, ptr + c * 2, 2);
+			channels[c] = halfToFloat(half);
+		}
+		break;
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		numChannels = format == DXGI_FORMAT_R32_FLOAT ? 1 : format == DXGI_FORMAT_R32G32_FLOAT ? 2 : 4;
+		memcpy(channels, ptr, numChannels * 4);
+		break;
+	default:
+		assert(false);
+	}
+	return float4(channels[0], channels[1], channels[2], channels[3]);
+}
+
+// Floats from raw memory. Reads past the bound range return zero.
+static float4 readFloats(const std::vector<unsigned char>& data, size_t boundBytes, unsigned offset, unsigned count)
+{
+	float channels[4] = {};
+	for (unsigned c = 0; c < count; c++)
+	{
+		if (offset + c * 4 + 4 <= min(data.size(), boundBytes))
+			memcpy(&channels[c], &data[offset + c * 4], 4);
+	}
+	return float4(channels[0], channels[1], channels[2], channels[3]);
+}
+
+// Source bytes visible through a view. Loads past the view range return zero on the GPU, textures and
+// buffers without a view desc see the whole resource.
+static size_t getViewBytes(const ShaderResourceView& view, size_t resourceBytes)
+{
+	if (!view.desc || view.desc->ViewDimension != D3D12_SRV_DIMENSION_BUFFER)
+		return resourceBytes;
+
+	// The reference indexes the source data from the start of the resource
+	const D3D12_BUFFER_SRV& buffer = view.desc->Buffer;
+	assert(buffer.FirstElement == 0);
+	if (buffer.Flags & D3D12_BUFFER_SRV_FLAG_RAW)
+		return min(resourceBytes, (size_t)buffer.NumElements * 4);
+	if (buffer.StructureByteStride != 0)
+		return min(resourceBytes, (size_t)buffer.NumElements * buffer.StructureByteStride);
+	return min(resourceBytes, (size_t)buffer.NumElements * getFormatBytes(view.desc->Format));
+}
+
+static uint32_t hash1(uint32_t c)
+{
+	return c * 0x3504f333;
+}
+
+Validator::Validator(DirectXDevice& dx, const UnorderedAccessView& output, const ShaderResourceView& gatherIndices, const ShaderResourceView& traceIndices) :
+	dx(dx), output(output), gatherIndices(gatherIndices), traceIndices(traceIndices)
+{
+	// Output is cleared to NaN before every validation dispatch. Catches kernels that don't write at all.
+	outputBytes = (unsigned)output.resource->GetDesc().Width;
+	std::vector<unsigned char> clearData(outputBytes, 0xff);
+	outputClear = dx.createUploadBuffer(outputBytes);
+	dx.writeBuffer(outputClear.Get(), clearData.data(), outputBytes);
+}
+
+void Validator::setSourceData(ID3D12Resource* resource, std::vector<unsigned char> data)
+{
+	sourceData[resource] = std::move(data);
+}
+
+void Validator::setConstants(ID3D12Resource* cb, const void* data, unsigned bytes)
+{
+	std::vector<unsigned char>& constants = sourceData[cb];
+	constants.assign((const unsigned char*)data, (const unsigned char*)data + bytes);
+}
+
+unsigned Validator::recordTestCase(
+	const std::string& name,
+	const KernelDesc& kernel,
+	const ComputePSO& shader,
+	ID3D12Resource* cb,
+	const ShaderResourceView& source,
+	const SamplerState* sampler,
+	uint3 threadCount,
+	uint3 groupSize)
+{
+	assert(sourceData.contains(cb));
+	Record record = {
+		.kernel = kernel,
+		.format = DXGI_FORMAT_UNKNOWN,
+		.width = 0,
+		.sourceData = nullptr,
+		.boundBytes = 0,
+		.constants = sourceData[cb] };
+
+	if (source.resource)
+	{
+		assert(sourceData.contains(source.resource));
+		record.sourceData = &sourceData[source.resource];
+
+		// Root descriptors have no view, they see the whole buffer
+		const ComputePSO::Binding* binding = shader.getBinding(0, ComputePSO::EBindingType::kSrv);
+		bool rootDescriptor = binding && binding->isRootDescriptor;
+		record.boundBytes = rootDescriptor ? record.sourceData->size() : getViewBytes(source, record.sourceData->size());
+	}
+
+	bool texture = kernel.resource == KernelResource::Texture || kernel.resource == KernelResource::SampledTexture;
+	if (kernel.resource == KernelResource::Typed)
+	{
+		record.format = source.desc->Format;
+	}
+	else if (texture)
+	{
+		D3D12_RESOURCE_DESC desc = source.resource->GetDesc();
+		record.format = desc.Format;
+		record.width = (unsigned)desc.Width;
+	}
+
+	// Written threads cover the start, the hashed offsets of the random pattern and the end of a group.
+	// Texture kernels use 16x16 groups, the write index is (y << 8) | x. Trace kernels use 1d groups.
+	if (texture && kernel.pattern != KernelPattern::Trace)
+		record.writeIndices = { 0x0000, 0x0001, 0x0305, 0x0f0f };
+	else
+		record.writeIndices = { 0, 1, 7, 255 };
+
+	unsigned numValidations = (unsigned)record.writeIndices.size();
+	record.readback = dx.createReadbackBuffer(numValidations * outputBytes);
+	for (unsigned i = 0; i < numValidations; i++)
+	{
+		// Copy of the benchmark constants with writes enabled
+		std::vector<unsigned char> constants = record.constants;
+		memcpy(&constants[offsetof(LoadConstants, writeIndex)], &record.writeIndices[i], sizeof(uint32_t));
+		ComPtr<ID3D12Resource> validationCB = dx.createConstantBuffer((unsigned)constants.size());
+		dx.updateConstantBuffer(validationCB.Get(), constants.data(), (unsigned)constants.size());
+		record.cbs.push_back(validationCB);
+
+		if (outputState != D3D12_RESOURCE_STATE_COPY_DEST)
+			dx.transitionResource(output.resource, outputState, D3D12_RESOURCE_STATE_COPY_DEST);
+		dx.copyBuffer(output.resource, 0, outputClear.Get(), 0, outputBytes);
+		dx.transitionResource(output.resource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+		if (sampler)
+			dx.dispatch(shader, threadCount, groupSize, { validationCB.Get() }, { &source, &gatherIndices, &traceIndices }, { &output }, { sampler });
+		else
+			dx.dispatch(shader, threadCount, groupSize, { validationCB.Get() }, { &source, &gatherIndices, &traceIndices }, { &output });
+
+		dx.transitionResource(output.resource, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+		dx.copyBuffer(record.readback.Get(), i * outputBytes, output.resource, 0, outputBytes);
+
+		// Timed dispatches of the same frame expect the output as a UAV
+		dx.transitionResource(output.resource, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		outputState = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+	}
+
+	records.push_back(std::move(record));
+	results.push_back({ .name = name });
+	return (unsigned)results.size() - 1;
+}
+
+float4 Validator::fetch(const Record& record, uint2 element) const
+{
+	const KernelDesc& kernel = record.kernel;
+	switch (kernel.resource)
+	{
+	case KernelResource::Raw:
+		return readFloats(*record.sourceData, record.boundBytes, element.x, kernel.loadWidth);		// Byte address
+	case KernelResource::Structured:
+		return readFloats(*record.sourceData, record.boundBytes, element.x * kernel.loadWidth * 4, kernel.loadWidth);
+	case KernelResource::Constant:
+		return readFloats(record.constants, record.constants.size(), offsetof(LoadConstantsWithArray, benchmarkArray) + element.x * 16, 4);
+	case KernelResource::Typed:
+	case KernelResource::Texture:
+	case KernelResource::SampledTexture:
+	{
+		// Sampling at texel centers returns the texel for both nearest and bilinear filtering
+		unsigned formatBytes = getFormatBytes(record.format);
+		size_t offset = ((size_t)element.y * record.width + element.x) * formatBytes;
+		if (offset + formatBytes > record.boundBytes)
+			return float4();
+		return decodeFormat(record.format, &(*record.sourceData)[offset]);
+	}
+	}
+	return float4();
+}
+
+// 8-bit Morton code to 4-bit x and y
+static uint2 mortonDecode(uint32_t code)
+{
+	uint32_t x = code & 0x55, y = (code >> 1) & 0x55;
+	x = (x | (x >> 1)) & 0x33;
+	y = (y | (y >> 1)) & 0x33;
+	x = (x | (x >> 2)) & 0x0f;
+	y = (y | (y >> 2)) & 0x0f;
+	return uint2((int)x, (int)y);
+}
+
+// Same as patternStart in accessPattern.hlsli
+unsigned Validator::patternStart(KernelPattern pattern, unsigned gix, const LoadConstants& constants) const
+{
+	switch (pattern)
+	{
+	case KernelPattern::Linear:
+		return gix;
+	case KernelPattern::Random:
+		return hash1(gix) & 0xf;
+	case KernelPattern::Strided:
+		return (gix * PATTERN_STRIDE) & 0x1ff;
+	case KernelPattern::Morton:
+	{
+		uint2 xy = mortonDecode(gix);
+		return xy.y * 32 + xy.x;
+	}
+	case KernelPattern::Divergent:
+		return (gix % constants.patternWays) * 8;
+	case KernelPattern::Clustered:
+		return (hash1(gix / PATTERN_CLUSTER) & 0xf) * PATTERN_CLUSTER + gix % PATTERN_CLUSTER;
+	case KernelPattern::Indexed:
+		return getGatherIndex(gix);
+	case KernelPattern::Paged:
+		return gix * constants.pageStride;
+	default:
+		return 0;
+	}
+}
+
+// Same as patternStart2d in accessPattern.hlsli
+uint2 Validator::patternStart2d(KernelPattern pattern, uint2 gid, const LoadConstants& constants) const
+{
+	unsigned gix = gid.y * 16 + gid.x;
+	switch (pattern)
+	{
+	case KernelPattern::Linear:
+		return gid;
+	case KernelPattern::Random:
+		return uint2(hash1(gid.x) & 0x4, hash1(gid.y) & 0x4);
+	case KernelPattern::Strided:
+		return uint2((gid.x * PATTERN_STRIDE) & 0xf, (gid.y * PATTERN_STRIDE) & 0xf);
+	case KernelPattern::Morton:
+		return mortonDecode(gix);
+	case KernelPattern::Divergent:
+	{
+		unsigned way = gix % constants.patternWays;
+		return uint2((way % 8) * 2, (way / 8) * 2);
+	}
+	case KernelPattern::Clustered:
+		return uint2((hash1(gid.x / 4) & 0xc) + gid.x % 4, (hash1(gid.y / 4) & 0xc) + gid.y % 4);
+	case KernelPattern::Indexed:
+	{
+		unsigned index = getGatherIndex(gix);
+		return uint2(index & 0xf, index >> 4);
+	}
+	default:
+		return uint2();
+	}
+}
+
+unsigned Validator::getGatherIndex(unsigned gix) const
+{
+	auto data = sourceData.find(gatherIndices.resource);
+	assert(data != sourceData.end());
+	uint32_t index = 0;
+	if (gix < GATHER_INDEX_COUNT)
+		memcpy(&index, &data->second[gix * 4], 4);
+	return index;
+}
+
+float Validator::reference(const Record& record, unsigned writeIndex) const
+{
+	const KernelDesc& kernel = record.kernel;
+	LoadConstants constants;
+	memcpy(&constants, record.constants.data(), sizeof(constants));
+
+	// Same swizzles as the kernels: .xxxx, .xyxy, .xyzx and .xyzw
+	auto swizzle = [&](float4 v)
+	{
+		switch (kernel.loadWidth)
+		{
+		case 1: return float4(v.x, v.x, v.x, v.x);
+		case 2: return float4(v.x, v.y, v.x, v.y);
+		case 3: return float4(v.x, v.y, v.z, v.x);
+		default: return v;
+		}
+	};
+
+	if (kernel.pattern == KernelPattern::Trace)
+		return referenceTrace(record, writeIndex, constants);
+
+	float4 value;
+	if (kernel.resource == KernelResource::Texture || kernel.resource == KernelResource::SampledTexture)
+	{
+		uint2 gid(writeIndex & 0xff, (writeIndex >> 8) & 0xff);
+		uint2 htid = patternStart2d(kernel.pattern, gid, constants);
+
+		for (unsigned y = 0; y < 16; y++)
+		{
+			for (unsigned x = 0; x < 16; x++)
+			{
+				uint2 element((htid.x + x) | constants.elementsMask, (htid.y + y) | constants.elementsMask);
+				value = value + swizzle(fetch(record, element));
+			}
+		}
+	}
+	else
+	{
+		unsigned htid = patternStart(kernel.pattern, writeIndex, constants);
+
+		if (kernel.element != KernelElement::Float32)
+			return referenceNative(record, htid, constants);
+
+		// Struct layout kernels: fieldsRead float4 fields of STRUCTS_PER_THREAD consecutive structs
+		if (kernel.structBytes)
+		{
+			for (unsigned i = 0; i < STRUCTS_PER_THREAD; i++)
+			{
+				unsigned structIdx = ((htid + i) & (STRUCT_COUNT - 1)) | constants.elementsMask;
+				for (unsigned field = 0; field < kernel.fieldsRead; field++)
+				{
+					unsigned offset = kernel.resource == KernelResource::StructSoa ?
+						(field * STRUCT_COUNT + structIdx) * 16 :
+						structIdx * kernel.structBytes + field * 16;
+					value = value + readFloats(*record.sourceData, record.boundBytes, offset, 4);
+				}
+			}
+			return value.x + value.y + value.z + value.w;
+		}
+
+		for (unsigned i = 0; i < kernel.loadsPerThread; i++)
+		{
+			unsigned element = (htid + i) | constants.elementsMask;
+			if (kernel.resource == KernelResource::Raw)
+				element = (htid * 4 * kernel.loadWidth + constants.readStartAddress + i * 4 * kernel.loadWidth) | constants.elementsMask;
+			value = value + swizzle(fetch(record, uint2(element, 0)));
+		}
+	}
+	return value.x + value.y + value.z + value.w;
+}
+
+float Validator::referenceNative(const Record& record, unsigned htid, const LoadConstants& constants) const
+{
+	// Native type kernels accumulate in their element type: 16-bit floats round after every add, integers wrap
+	const KernelDesc& kernel = record.kernel;
+	auto add = [&](uint64_t a, uint64_t b) -> uint64_t
+	{
+		switch (kernel.element)
+		{
+		case KernelElement::Float16:
+			return doubleToHalf((double)halfToFloat((uint16_t)a) + (double)halfToFloat((uint16_t)b));
+		case KernelElement::Uint16:
+			return (a + b) & 0xffff;
+		default:
+			return a + b;
+		}
+	};
+
+	unsigned elementBytes = getElementBytes(kernel.element);
+	unsigned loadBytes = elementBytes * kernel.loadWidth;
+	size_t boundBytes = min(record.sourceData->size(), record.boundBytes);
+	uint64_t value[4] = {};
+	for (unsigned i = 0; i < kernel.loadsPerThread; i++)
+	{
+		unsigned address = kernel.resource == KernelResource::Raw ?
+			(htid * loadBytes + constants.readStartAddress + i * loadBytes) | constants.elementsMask :
+			((htid + i) | constants.elementsMask) * loadBytes;
+
+		uint64_t channels[4] = {};
+		for (unsigned c = 0; c < kernel.loadWidth; c++)
+		{
+			size_t offset = (size_t)address + c * elementBytes;
+			if (offset + elementBytes <= boundBytes)
+				memcpy(&channels[c], &(*record.sourceData)[offset], elementBytes);
+		}
+
+		// Same swizzles as the kernels: .xxxx, .xyxy and .xyzw
+		for (unsigned lane = 0; lane < 4; lane++)
+			value[lane] = add(value[lane], channels[lane % kernel.loadWidth]);
+	}
+
+	uint64_t sum = add(add(add(value[0], value[1]), value[2]), value[3]);
+	if (kernel.element == KernelElement::Float16)
+		return halfToFloat((uint16_t)sum);
+	return (float)sum;
+}
+
+void Validator::check()
+{
+	unsigned outputElements = outputBytes / sizeof(float);
+	std::vector<float> outputData(outputElements);
+
+	for (size_t recordIndex = 0; recordIndex < records.size(); recordIndex++)
+	{
+		const Record& record = records[recordIndex];
+		ValidationResult& result = results[recordIndex];
+
+		std::vector<float> readbackData(record.writeIndices.size() * outputElements);
+		dx.readBuffer(record.readback.Get(), readbackData.data(), (unsigned)(readbackData.size() * sizeof(float)));
+
+		for (size_t i = 0; i < record.writeIndices.size() && result.passed; i++)
+		{
+			// Every thread writes the value of the same thread of its group. Threads of a 1024x1024
+			// dispatch cover output elements [0, 2046].
+			float expected = reference(record, record.writeIndices[i]);
+			float tolerance = max(std::fabs(expected) * 1e-4f, 1e-6f);
+			const float* values = &readbackData[i * outputElements];
+			for (unsigned element = 0; element < min(outputElements, 2047u); element++)
+			{
+				// NaN is also the cleared value. Only file contents can produce NaN inputs.
+				bool mismatch = std::isnan(expected) ?
+					!std::isnan(values[element]) :
+					std::isnan(values[element]) || std::fabs(values[element] - expected) > tolerance;
+				if (mismatch)
+				{
+					char message[256];
+					snprintf(
+						message,
+						sizeof(message),
+						"thread %#x: output[%u] = %f, expected %f",
+						record.writeIndices[i],
+						element,
+						values[element],
+						expected);
+					result.passed = false;
+					result.message = message;
+					break;
+				}
+			}
+		}
+	}
+}
+
+unsigned Validator::getFailureCount() const
+{
+	unsigned failures = 0;
+	for (const ValidationResult& result : results)
+		failures += result.passed ? 0 : 1;
+	return failures;
+}
+
+float Validator::referenceTrace(const Record& record, unsigned gix, const LoadConstants& constants) const
+{
+	// Same as loadTraceBody.hlsli: thread gix replays traced thread gix % traceThreads
+	auto data = sourceData.find(traceIndices.resource);
+	assert(data != sourceData.end());
+	unsigned thread = gix % constants.traceThreads;
+
+	float4 value;
+	for (unsigned i = 0; i < constants.traceLoads; i++)
+	{
+		uint32_t index = 0;
+		memcpy(&index, &data->second[((size_t)i * constants.traceThreads + thread) * 4], 4);
+		unsigned element = index | constants.elementsMask;
+
+		if (record.kernel.resource == KernelResource::Raw)
+			value = value + fetch(record, uint2(element * 16, 0));		// Byte address
+		else if (record.kernel.resource == KernelResource::Texture)
+			value = value + fetch(record, uint2(element % TRACE_TEXTURE_WIDTH, element / TRACE_TEXTURE_WIDTH));
+		else
+			value = value + fetch(record, uint2(element, 0));
+	}
+	return value.x + value.y + value.z + value.w;
+}
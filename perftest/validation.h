@@ -0,0 +1,79 @@
+#pragma once
+#include "directx.h"
+#include "kernelDesc.h"
+#include <unordered_map>
+#include <vector>
+
+struct LoadConstants;
+
+struct ValidationResult
+{
+	std::string name;
+	bool passed = true;
+	std::string message;
+};
+
+// Correctness check of the benchmark kernels. The kernels are dispatched with writes enabled, and
+// the output is read back and compared against a host side reference of the kernel.
+class Validator
+{
+public:
+	// gatherIndices, traceIndices: index buffers of the indexed pattern and trace kernels, their data is set with setSourceData
+	Validator(DirectXDevice& dx, const UnorderedAccessView& output, const ShaderResourceView& gatherIndices, const ShaderResourceView& traceIndices);
+
+	// CPU copy of the input resource contents for the reference. Textures are tightly packed.
+	void setSourceData(ID3D12Resource* resource, std::vector<unsigned char> data);
+
+	// CPU copy of constant buffer contents (LoadConstants or LoadConstantsWithArray)
+	void setConstants(ID3D12Resource* cb, const void* data, unsigned bytes);
+
+	// Records the validation dispatches of a test case into the current frame. Returns the result index.
+	unsigned recordTestCase(
+		const std::string& name,
+		const KernelDesc& kernel,
+		const ComputePSO& shader,
+		ID3D12Resource* cb,
+		const ShaderResourceView& source,
+		const SamplerState* sampler,
+		uint3 threadCount,
+		uint3 groupSize);
+
+	// Compares the read back outputs against the reference. The GPU must be idle.
+	void check();
+
+	const std::vector<ValidationResult>& getResults() const { return results; }
+	unsigned getFailureCount() const;
+
+private:
+	struct Record
+	{
+		KernelDesc kernel;
+		DXGI_FORMAT format;					// Typed and texture views
+		unsigned width;						// Texture width in texels
+		const std::vector<unsigned char>* sourceData;
+		size_t boundBytes;					// Source bytes visible through the binding
+		std::vector<unsigned char> constants;
+		std::vector<unsigned> writeIndices;	// One validation dispatch per written thread
+		ComPtr<ID3D12Resource> readback;
+		std::vector<ComPtr<ID3D12Resource>> cbs;
+	};
+
+	float4 fetch(const Record& record, uint2 element) const;
+	float reference(const Record& record, unsigned writeIndex) const;
+	float referenceNative(const Record& record, unsigned htid, const LoadConstants& constants) const;
+	float referenceTrace(const Record& record, unsigned gix, const LoadConstants& constants) const;
+	unsigned patternStart(KernelPattern pattern, unsigned gix, const LoadConstants& constants) const;
+	uint2 patternStart2d(KernelPattern pattern, uint2 gid, const LoadConstants& constants) const;
+	unsigned getGatherIndex(unsigned gix) const;
+
+	DirectXDevice& dx;
+	const UnorderedAccessView& output;
+	const ShaderResourceView& gatherIndices;
+	const ShaderResourceView& traceIndices;
+	unsigned outputBytes;
+	ComPtr<ID3D12Resource> outputClear;
+	D3D12_RESOURCE_STATES outputState = D3D12_RESOURCE_STATE_COMMON;
+	std::unordered_map<ID3D12Resource*, std::vector<unsigned char>> sourceData;
+	std::vector<Record> records;
+	std::vector<ValidationResult> results;
+};
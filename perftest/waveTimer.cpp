@@ -0,0 +1,142 @@
+#include "waveTimer.h"
+#include "loadConstantsGPU.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstdio>
+#include <cstring>
+
+WaveTimer::WaveTimer(DirectXDevice& dx, const UnorderedAccessView& output) :
+	dx(dx),
+	output(output),
+	timingBytes(WAVE_TIMING_HEADER_BYTES + MAX_TIMED_WAVES * sizeof(WaveRecord)),
+	timingBuffer(dx.createBuffer(timingBytes / 4, 4)),
+	timingUAV(dx.createByteAddressUAV(timingBuffer.Get(), timingBytes / 4))
+{
+	std::vector<unsigned char> zeros(WAVE_TIMING_HEADER_BYTES, 0);
+	counterClear = dx.createUploadBuffer(WAVE_TIMING_HEADER_BYTES);
+	dx.writeBuffer(counterClear.Get(), zeros.data(), WAVE_TIMING_HEADER_BYTES);
+}
+
+void WaveTimer::recordDispatch(
+	const std::string& name,
+	const ComputePSO& shader,
+	ID3D12Resource* cb,
+	const ShaderResourceView& source,
+	uint3 threadCount,
+	uint3 groupSize)
+{
+	// The event and wave counters start from zero in every dispatch
+	if (timingState != D3D12_RESOURCE_STATE_COPY_DEST)
+		dx.transitionResource(timingBuffer.Get(), timingState, D3D12_RESOURCE_STATE_COPY_DEST);
+	dx.copyBuffer(timingBuffer.Get(), 0, counterClear.Get(), 0, WAVE_TIMING_HEADER_BYTES);
+	dx.transitionResource(timingBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+
+	dx.dispatch(shader, threadCount, groupSize, { cb }, { &source }, { &output, &timingUAV });
+
+	dx.transitionResource(timingBuffer.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	timingState = D3D12_RESOURCE_STATE_COPY_SOURCE;
+	Dispatch dispatch = { .name = name, .readback = dx.createReadbackBuffer(timingBytes) };
+	dx.copyBuffer(dispatch.readback.Get(), 0, timingBuffer.Get(), 0, timingBytes);
+	dispatches.push_back(dispatch);
+}
+
+void WaveTimer::report(const std::string& csvFilename)
+{
+	FILE* csv = nullptr;
+	if (!csvFilename.empty())
+	{
+		fopen_s(&csv, csvFilename.c_str(), "w");
+		if (csv)
+			fprintf(csv, "kernel,wave,start_event,end_event,thread_x,thread_y,lanes\n");
+		else
+			printf("Can't write %s\n", csvFilename.c_str());
+	}
+
+	// The clock is an event counter, not a time: the summaries are event order and overlap counts
+	printf("\nWave event order (every wave start and end is one event of a global counter):\n\n");
+	std::vector<uint32_t> data(timingBytes / 4);
+	for (const Dispatch& dispatch : dispatches)
+	{
+		dx.readBuffer(dispatch.readback.Get(), data.data(), timingBytes);
+		uint32_t totalEvents = data[0];
+		uint32_t numWaves = min(data[1], (uint32_t)MAX_TIMED_WAVES);
+		std::vector<WaveRecord> waves(numWaves);
+		memcpy(waves.data(), &data[WAVE_TIMING_HEADER_BYTES / 4], numWaves * sizeof(WaveRecord));
+
+		printSummary(dispatch.name, totalEvents, waves);
+
+		if (csv)
+		{
+			for (uint32_t i = 0; i < numWaves; i++)
+			{
+				const WaveRecord& wave = waves[i];
+				fprintf(csv, "\"%s\",%u,%u,%u,%u,%u,%u\n", dispatch.name.c_str(), i, wave.start, wave.end,
+					wave.firstThread & 0xffff, wave.firstThread >> 16, wave.lanes);
+			}
+		}
+	}
+
+	if (csv)
+		fclose(csv);
+}
+
+void WaveTimer::printSummary(const std::string& name, uint32_t totalEvents, const std::vector<WaveRecord>& waves)
+{
+	if (waves.empty() || totalEvents == 0)
+	{
+		printf("%s: no waves recorded\n", name.c_str());
+		return;
+	}
+
+	// Overlap of every wave: start and end events of the other waves between its own two. Sorted for the
+	// median and the 90% and 99% marks, and a histogram of 10 bins up to the largest overlap.
+	std::vector<uint32_t> overlaps;
+	for (const WaveRecord& wave : waves)
+		overlaps.push_back(wave.end - wave.start - 1);
+	std::sort(overlaps.begin(), overlaps.end());
+	auto rank = [&](unsigned p) { return overlaps[min(overlaps.size() * p / 100, overlaps.size() - 1)]; };
+	uint32_t largest = overlaps.back();
+
+	unsigned histogram[10] = {};
+	for (uint32_t overlap : overlaps)
+		histogram[min(overlap * 10ull / (largest + 1), 9ull)]++;
+
+	// Event order timeline: waves in flight at every event, and the events after the last wave started
+	std::vector<int> inFlightDelta(totalEvents + 1, 0);
+	uint32_t lastStart = 0;
+	for (const WaveRecord& wave : waves)
+	{
+		inFlightDelta[min(wave.start, totalEvents)]++;
+		inFlightDelta[min(wave.end, totalEvents)]--;
+		lastStart = max(lastStart, wave.start);
+	}
+	int inFlight = 0;
+	int peakInFlight = 0;
+	uint64_t inFlightSum = 0;
+	for (uint32_t event = 0; event < totalEvents; event++)
+	{
+		inFlight += inFlightDelta[event];
+		peakInFlight = max(peakInFlight, inFlight);
+		inFlightSum += inFlight;
+	}
+
+	// Records are in slot order, which follows the start order. Uneven scheduling shows as different overlaps of the first and last waves.
+	size_t tenth = max(waves.size() / 10, (size_t)1);
+	uint64_t firstSum = 0, lastSum = 0;
+	for (size_t i = 0; i < tenth; i++)
+	{
+		firstSum += waves[i].end - waves[i].start - 1;
+		lastSum += waves[waves.size() - 1 - i].end - waves[waves.size() - 1 - i].start - 1;
+	}
+
+	printf("%s: %zu waves of %u lanes, %u start/end events\n", name.c_str(), waves.size(), waves[0].lanes, totalEvents);
+	printf("  overlap (events of other waves while in flight): median %u, 90%% of the waves <= %u, 99%% <= %u, max %u\n",
+		rank(50), rank(90), rank(99), largest);
+	printf("  overlap histogram (10 bins up to max):");
+	for (unsigned count : histogram)
+		printf(" %u", count);
+	printf("\n");
+	printf("  in flight per event: peak %d, mean %.1f; events after the last start: %.2f%%\n",
+		peakInFlight, (double)inFlightSum / totalEvents, (totalEvents - lastStart) * 100.0 / totalEvents);
+	printf("  first/last 10%% of the waves: mean overlap %.1f / %.1f events\n", (double)firstSum / tenth, (double)lastSum / tenth);
+}
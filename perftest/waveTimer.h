@@ -0,0 +1,53 @@
+#pragma once
+#include "directx.h"
+#include <string>
+#include <vector>
+
+// Per wave event order of the instrumented load kernels (waveTiming.hlsli). Every wave records its start
+// and end event of a global counter, the records are read back and summarized as overlap counts and an
+// event order timeline. There is no shader clock, so these are orders, not durations. Dispatch timestamps
+// only show the total, not the tail or uneven wave scheduling.
+class WaveTimer
+{
+public:
+	WaveTimer(DirectXDevice& dx, const UnorderedAccessView& output);
+
+	// Records an instrumented dispatch into the current frame. Its records are read back by report.
+	void recordDispatch(
+		const std::string& name,
+		const ComputePSO& shader,
+		ID3D12Resource* cb,
+		const ShaderResourceView& source,
+		uint3 threadCount,
+		uint3 groupSize);
+
+	// Prints a summary per dispatch. Writes every wave record to csvFilename, unless it's empty.
+	// The GPU must be idle.
+	void report(const std::string& csvFilename);
+
+private:
+	struct WaveRecord
+	{
+		uint32_t start;				// Event counter values
+		uint32_t end;
+		uint32_t firstThread;		// (y << 16) | x
+		uint32_t lanes;
+	};
+
+	struct Dispatch
+	{
+		std::string name;
+		ComPtr<ID3D12Resource> readback;
+	};
+
+	void printSummary(const std::string& name, uint32_t totalEvents, const std::vector<WaveRecord>& waves);
+
+	DirectXDevice& dx;
+	const UnorderedAccessView& output;
+	unsigned timingBytes;
+	ComPtr<ID3D12Resource> timingBuffer;
+	UnorderedAccessView timingUAV;
+	ComPtr<ID3D12Resource> counterClear;
+	D3D12_RESOURCE_STATES timingState = D3D12_RESOURCE_STATE_COMMON;
+	std::vector<Dispatch> dispatches;
+};
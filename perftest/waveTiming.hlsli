@@ -0,0 +1,47 @@
+// Per wave event order of the buffer load kernels (waveTimer.h). Define WAVE_TIMING to record the start and
+// end event of every wave. Include after the loadConstants cbuffer.
+//
+// D3D12 has no portable shader clock. The clock is a logical one instead: a global counter incremented
+// by every wave start and end, so the events order the waves and count the overlap between them, but
+// don't measure time. The atomic is shared by all waves and serializes their starts and ends a little.
+// Vendor clocks (AGS, NVAPI shader extensions) could replace waveClock.
+
+#if defined(WAVE_TIMING)
+// Event counter, wave counter, 2 unused words, then one record per wave: start, end, first thread (y << 16 | x), lanes
+RWByteAddressBuffer waveTimings : register(u1);
+#define WAVE_TIMING_UAVS "UAV(u1, flags = DESCRIPTORS_VOLATILE | DATA_VOLATILE),"
+
+uint waveClock(uint increment)
+{
+	uint counter = 0;
+	if (WaveIsFirstLane())
+		waveTimings.InterlockedAdd(0, increment, counter);
+	return WaveReadLaneFirst(counter);
+}
+#else
+#define WAVE_TIMING_UAVS
+#endif
+
+// Start event and record slot of the wave
+uint2 waveTimingBegin()
+{
+#if defined(WAVE_TIMING)
+	uint slot = 0;
+	if (WaveIsFirstLane())
+		waveTimings.InterlockedAdd(4, 1, slot);
+	return uint2(waveClock(1), WaveReadLaneFirst(slot));
+#else
+	return 0;
+#endif
+}
+
+// result: accumulated loads of the thread. The end event waits for them.
+void waveTimingEnd(uint2 begin, uint3 tid, float result)
+{
+#if defined(WAVE_TIMING)
+	// elementsMask is always 0, but the compiler doesn't know this
+	uint end = waveClock(1 + (asuint(result) & loadConstants.elementsMask));
+	if (WaveIsFirstLane() && begin.y < MAX_TIMED_WAVES)
+		waveTimings.Store4(WAVE_TIMING_HEADER_BYTES + begin.y * 16, uint4(begin.x, end, (tid.y << 16) | tid.x, WaveGetLaneCount()));
+#endif
+}